@@ -0,0 +1,111 @@
+#include <iostream>
+#include "cellLib.h"
+
+using namespace std;
+
+/*
+  Cell name keywords, longest first: a name is resolved by the first keyword
+  it contains, so "xnor2" is never taken for a nor and "nand3" never for an and.
+*/
+static const struct {
+  const char *keyword;
+  cellType type;
+} cellKeywords[] = {
+  { "buffer", CELL_BUFFER },
+  { "xnor",   CELL_XNOR },
+  { "nand",   CELL_NAND },
+  { "xor",    CELL_XOR },
+  { "nor",    CELL_NOR },
+  { "and",    CELL_AND },
+  { "inv",    CELL_INV },
+  { "not",    CELL_INV },
+  { "dff",    CELL_DFF },
+  { "or",     CELL_OR }
+};
+
+bool cellLibrary::typeOf(const string &cellName, cellType &type){
+  for(size_t k=0; k<sizeof(cellKeywords)/sizeof(cellKeywords[0]); k++){
+    if(cellName.find(cellKeywords[k].keyword)!=string::npos){
+      type=cellKeywords[k].type;
+      return true;
+    }
+  }
+  return false;
+}
+
+int cellDesc::pinIndex(const string &pin) const{
+  for(size_t p=0; p<pins.size(); p++){
+    if(pins[p]==pin) return p;
+  }
+  return -1;
+}
+
+cellLibrary::~cellLibrary(){
+  for(map<hcmCell*, cellDesc*>::iterator I=cells.begin(); I!=cells.end(); I++){
+    delete I->second;
+  }
+}
+
+const cellDesc *cellLibrary::lookup(hcmCell *master){
+  map<hcmCell*, cellDesc*>::iterator I=cells.find(master);
+  if(I!=cells.end()) return I->second;
+
+  cellDesc *d=new cellDesc;
+  d->name=master->getName();
+  d->output=-1;
+  d->clock=-1;
+  bool ok=typeOf(d->name, d->type);
+  if(!ok){
+    cerr << "-E- does not support gate type: " << d->name << " aborting." << endl;
+  }
+  vector<hcmPort*> ports=master->getPorts();
+  for(size_t p=0; ok && p<ports.size(); p++){
+    d->pins.push_back(ports[p]->getName());
+    d->dirs.push_back(ports[p]->getDirection());
+    if(ports[p]->getDirection()==OUT){
+      if(d->output>=0){
+        cerr << "-E- cell " << d->name << " has more than one output, aborting." << endl;
+        ok=false;
+      }
+      d->output=p;
+    } else if(ports[p]->getDirection()==IN){
+      if(d->type==CELL_DFF && ports[p]->getName()=="CLK"){
+        d->clock=p;
+      } else {
+        d->inputs.push_back(p);
+      }
+    }
+  }
+  if(ok && d->output<0){
+    cerr << "-E- cell " << d->name << " has no output, aborting." << endl;
+    ok=false;
+  }
+  if(ok && d->inputs.empty()){
+    cerr << "-E- cell " << d->name << " has no inputs, aborting." << endl;
+    ok=false;
+  }
+  if(ok && d->type==CELL_DFF && (d->clock<0 || d->inputs.size()!=1)){
+    cerr << "-E- dff cell " << d->name << " must have exactly D and CLK inputs, aborting." << endl;
+    ok=false;
+  }
+  if(ok && (d->type==CELL_BUFFER || d->type==CELL_INV) && d->inputs.size()!=1){
+    cerr << "-E- cell " << d->name << " must have a single input, aborting." << endl;
+    ok=false;
+  }
+  if(!ok){
+    delete d;
+    return NULL;
+  }
+  cells[master]=d;
+  return d;
+}
+
+void cellLibrary::pinNodes(const cellDesc &desc, hcmInstance *inst, vector<hcmNode*> &nodes){
+  nodes.assign(desc.pins.size(), (hcmNode*)NULL);
+  std::map<std::string, hcmInstPort* >::const_iterator ipI;
+  for (ipI =inst->getInstPorts().begin(); ipI != inst->getInstPorts().end(); ipI++){
+    hcmInstPort* ip= ipI->second;
+    int p=desc.pinIndex(ip->getPort()->getName());
+    if(p>=0) nodes[p]=ip->getNode();
+  }
+}
@@ -0,0 +1,59 @@
+#ifndef CELL_LIB_H
+#define CELL_LIB_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "hcm.h"
+
+/*
+  Cell library shared by the simulator (wet2) and the equivalence checker
+  (wet03). Every master cell is resolved once to a cellDesc holding its
+  function (opcode), its pin directions and the order of its pins, so the
+  tools never match cell names while simulating or encoding.
+*/
+
+// gate function of a cell
+enum cellType {
+  CELL_AND,
+  CELL_NAND,
+  CELL_OR,
+  CELL_NOR,
+  CELL_XOR,
+  CELL_XNOR,
+  CELL_BUFFER,
+  CELL_INV,
+  CELL_DFF
+};
+
+class cellDesc {
+  public:
+    std::string name;                 // master cell name
+    cellType type;
+    std::vector<std::string> pins;    // port names in declaration order
+    std::vector<char> dirs;           // pin -> hcmPortDir
+    std::vector<int> inputs;          // data input pins in order (a dff: only D)
+    int output;                       // output pin
+    int clock;                        // CLK pin of a dff, -1 for gates
+
+    // pin index of a port name, -1 if the cell has no such port
+    int pinIndex(const std::string &pin) const;
+    // true for the inverting functions (nand, nor, xnor, inv)
+    bool inverted() const { return type==CELL_NAND || type==CELL_NOR || type==CELL_XNOR || type==CELL_INV; }
+};
+
+class cellLibrary {
+  public:
+    ~cellLibrary();
+    // descriptor of a master cell, built on first use. NULL (after printing -E-) for unsupported cells
+    const cellDesc *lookup(hcmCell *master);
+    // nodes connected to the pins of inst, in the pin order of its descriptor (NULL when unconnected)
+    static void pinNodes(const cellDesc &desc, hcmInstance *inst, std::vector<hcmNode*> &nodes);
+    // function of a master cell name, returns false for unsupported cells
+    static bool typeOf(const std::string &cellName, cellType &type);
+
+  private:
+    std::map<hcmCell*, cellDesc*> cells;
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include <iostream>
+#include <set>
+#include "aig.h"
+
+using namespace std;
+
+aigGraph::aigGraph(){
+  // node 0: the constant false
+  fanin0.push_back(-1);
+  fanin1.push_back(-1);
+  names.push_back("");
+  hashHits=0;
+}
+
+int aigGraph::newInput(const string &name){
+  fanin0.push_back(-1);
+  fanin1.push_back(-1);
+  names.push_back(name);
+  return 2*(numNodes()-1);
+}
+
+int aigGraph::input(const string &name){
+  map<string, int>::const_iterator I = inputs.find(name);
+  if(I!=inputs.end()) return I->second;
+  int lit = newInput(name);
+  inputs[name]=lit;
+  return lit;
+}
+
+int aigGraph::state(const string &instName){
+  map<string, int>::const_iterator I = states.find(instName);
+  if(I!=states.end()) return I->second;
+  int lit = newInput(instName);
+  states[instName]=lit;
+  return lit;
+}
+
+/*
+  a AND b with constant propagation (x&0=0, x&1=x), the trivial cases
+  (x&x=x, x&~x=0) and the structural hash on the ordered input pair.
+*/
+int aigGraph::And(int a, int b){
+  if(a>b){
+    int t=a; a=b; b=t;
+  }
+  if(a==0) return 0;
+  if(a==1) return b;
+  if(a==b) return a;
+  if((a^1)==b) return 0;
+  uint64_t key = (uint64_t)a<<32 | (uint32_t)b;
+  unordered_map<uint64_t, int>::const_iterator I = strash.find(key);
+  if(I!=strash.end()){
+    hashHits++;
+    return I->second;
+  }
+  fanin0.push_back(a);
+  fanin1.push_back(b);
+  names.push_back("");
+  int lit = 2*(numNodes()-1);
+  strash[key]=lit;
+  return lit;
+}
+
+void aigCone(const aigGraph &g, const vector<int> &roots, vector<int> &nodes){
+  vector<char> in_cone(g.numNodes(), 0);
+  vector<int> stack;
+  for(size_t k=0; k<roots.size(); k++){
+    stack.push_back(aigNode(roots[k]));
+  }
+  while(!stack.empty()){
+    int n = stack.back();
+    stack.pop_back();
+    if(in_cone[n]) continue;
+    in_cone[n]=1;
+    if(g.isAnd(n)){
+      stack.push_back(aigNode(g.fanin0[n]));
+      stack.push_back(aigNode(g.fanin1[n]));
+    }
+  }
+  nodes.clear();
+  for(int n=0; n<g.numNodes(); n++){
+    if(in_cone[n]) nodes.push_back(n);
+  }
+}
+
+// literal of a gate over the literals of its inputs, multi input gates as a chain in pin order
+static int gateLit(aigGraph &g, const cellDesc &desc, const vector<int> &in){
+  int r=in[0];
+  switch(desc.type){
+    case CELL_AND:
+    case CELL_NAND:
+      for(size_t k=1; k<in.size(); k++) r=g.And(r, in[k]);
+      break;
+    case CELL_OR:
+    case CELL_NOR:
+      for(size_t k=1; k<in.size(); k++) r=g.Or(r, in[k]);
+      break;
+    case CELL_XOR:
+    case CELL_XNOR:
+      for(size_t k=1; k<in.size(); k++) r=g.Xor(r, in[k]);
+      break;
+    default:
+      break;
+  }
+  return desc.inverted() ? r^1 : r;
+}
+
+/*
+  The leaves (constants, input ports, dff outputs) get their literals first,
+  then every node is resolved depth first through its driving instance. The
+  walk uses an explicit stack: a node stays on it, marked open, until the
+  literals of all the inputs of its driver are known. Reaching an open node
+  again through an input means a combinational loop.
+*/
+bool aigAddCell(aigGraph &g, cellLibrary &lib, hcmCell *flatCell, map<hcmNode*, int> &lits){
+  map<hcmNode*, hcmInstance*> driver;
+  map<hcmNode*, const cellDesc*> driverCell;
+  vector<hcmNode*> pins;
+  std::map< std::string, hcmInstance* >::const_iterator iI;
+  for(iI =flatCell->getInstances().begin(); iI != flatCell->getInstances().end(); iI++){
+    hcmInstance *inst = iI->second;
+    const cellDesc *desc = lib.lookup(inst->masterCell());
+    if(!desc){
+      return false;
+    }
+    cellLibrary::pinNodes(*desc, inst, pins);
+    hcmNode *out = pins[desc->output];
+    if(!out){
+      cerr << "-E- instance " << inst->getName() << " has no output, aborting." << endl;
+      return false;
+    }
+    if(desc->type==CELL_DFF){
+      lits[out]=g.state(inst->getName());
+    } else {
+      driver[out]=inst;
+      driverCell[out]=desc;
+    }
+  }
+
+  std::map< std::string, hcmNode* >::const_iterator nI;
+  for(nI =flatCell->getNodes().begin(); nI != flatCell->getNodes().end(); nI++){
+    hcmNode *node = nI->second;
+    hcmPort *port = node->getPort();
+    if(node->getName()=="VDD"){
+      lits[node]=1;
+    } else if(node->getName()=="VSS"){
+      lits[node]=0;
+    } else if(port && port->getDirection()==IN){
+      lits[node]=g.input(node->getName());
+    }
+  }
+
+  set<hcmNode*> open;
+  vector<hcmNode*> stack;
+  vector<int> in;
+  for(nI =flatCell->getNodes().begin(); nI != flatCell->getNodes().end(); nI++){
+    stack.push_back(nI->second);
+    while(!stack.empty()){
+      hcmNode *node = stack.back();
+      if(lits.find(node)!=lits.end()){
+        stack.pop_back();
+        continue;
+      }
+      map<hcmNode*, hcmInstance*>::const_iterator D = driver.find(node);
+      if(D==driver.end()){
+        // undriven internal node: a free input of this cell only
+        lits[node]=g.newInput(node->getName());
+        stack.pop_back();
+        continue;
+      }
+      const cellDesc *desc = driverCell[node];
+      cellLibrary::pinNodes(*desc, D->second, pins);
+      bool ready=true;
+      in.clear();
+      for(size_t k=0; k<desc->inputs.size(); k++){
+        hcmNode *p = pins[desc->inputs[k]];
+        if(!p){
+          cerr << "-E- input " << desc->pins[desc->inputs[k]] << " of instance " << D->second->getName() << " is not connected, aborting." << endl;
+          return false;
+        }
+        map<hcmNode*, int>::const_iterator L = lits.find(p);
+        if(L!=lits.end()){
+          in.push_back(L->second);
+          continue;
+        }
+        if(open.find(p)!=open.end()){
+          cerr << "-E- combinational loop through instance " << D->second->getName() << " aborting." << endl;
+          return false;
+        }
+        ready=false;
+        stack.push_back(p);
+      }
+      if(!ready){
+        open.insert(node);
+        continue;
+      }
+      lits[node]=gateLit(g, *desc, in);
+      open.erase(node);
+      stack.pop_back();
+    }
+  }
+  return true;
+}
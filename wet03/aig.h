@@ -0,0 +1,65 @@
+#ifndef AIG_H
+#define AIG_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "hcm.h"
+#include "cellLib.h"
+
+/*
+  And-Inverter Graph shared by the spec and the implementation.
+  Every gate of both flat cells is rewritten into 2 input ANDs and inverted
+  edges. A literal is 2*node + complement, node 0 is the constant false so
+  literal 0 is false and literal 1 is true (VSS / VDD). Before an AND node is
+  created its inputs are simplified against the constants and against each
+  other, and the structural hash returns the existing node for the same pair
+  of input literals, so logic the two netlists have in common ends up as the
+  same node and the same literal.
+*/
+
+class aigGraph {
+  public:
+    std::vector<int> fanin0;           // node id -> first input literal, -1 for the constant and the inputs
+    std::vector<int> fanin1;           // node id -> second input literal
+    std::vector<std::string> names;    // node id -> name of a named input, empty otherwise
+    std::map<std::string, int> inputs; // primary input name -> literal, shared by both cells
+    std::map<std::string, int> states; // dff instance name -> literal of its output, shared by both cells
+    int hashHits;                      // ANDs found in the structural hash instead of created
+
+    aigGraph();
+    int numNodes() const { return fanin0.size(); }
+    bool isAnd(int node) const { return fanin0[node]>=0; }
+
+    // literal of a new free input
+    int newInput(const std::string &name);
+    // literal of a primary input / dff output, the same for both cells
+    int input(const std::string &name);
+    int state(const std::string &instName);
+
+    int And(int a, int b);
+    int Or(int a, int b) { return And(a^1, b^1)^1; }
+    int Xor(int a, int b) { return Or(And(a, b^1), And(a^1, b)); }
+
+  private:
+    std::unordered_map<uint64_t, int> strash; // (smaller, larger) input literals -> AND node
+};
+
+inline int aigNode(int lit){ return lit>>1; }
+inline bool aigCompl(int lit){ return lit&1; }
+
+// nodes in the transitive fan-in of the literals roots, in increasing (topological) order
+void aigCone(const aigGraph &g, const std::vector<int> &roots, std::vector<int> &nodes);
+
+/*
+  Add the gates of a flat cell to the AIG. lits gets the literal of every
+  node of the cell. Input ports use the shared inputs by name, the outputs of
+  a dff the shared state of its instance name, VDD/VSS the constants and any
+  other undriven node a new free input. Returns false (after printing -E-) on
+  an unsupported cell or a combinational loop.
+*/
+bool aigAddCell(aigGraph &g, cellLibrary &lib, hcmCell *flatCell, std::map<hcmNode*, int> &lits);
+
+#endif
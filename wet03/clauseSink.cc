@@ -0,0 +1,148 @@
+#include <iostream>
+#include <string.h>
+#include "clauseSink.h"
+
+using namespace Minisat;
+using namespace std;
+
+static const size_t bufSize = 1 << 20;  // formatted clauses written out per block
+static const int headerWidth = 48;      // reserved "p cnf" line, padded with spaces
+static const int gzHeaderData = 15;     // offset of the header line in the first gzip member: gzip header + stored block header
+
+clauseSink::clauseSink(Solver &solver) : numClauses(0), S(solver), f(NULL), gz(false), used(0), failed(false), toSolver(true){
+}
+
+clauseSink::~clauseSink(){
+  if(f){
+    if(gz) deflateEnd(&zs);
+    fclose(f);
+  }
+}
+
+string clauseSink::header(int nVars) const{
+  char line[headerWidth+1];
+  snprintf(line, sizeof(line), "p cnf %d %d", nVars, numClauses);
+  string h(line);
+  h.resize(headerWidth-1, ' ');
+  return h + "\n";
+}
+
+void clauseSink::output(const void *data, size_t size){
+  if(size && fwrite(data, 1, size, f)!=size){
+    failed=true;
+  }
+}
+
+bool clauseSink::open(const string &fileName, bool gzip){
+  name=fileName;
+  gz=gzip;
+  f=fopen(fileName.c_str(), "wb");
+  if(!f){
+    cerr << "-E- Could not open file:" << fileName << endl;
+    return false;
+  }
+  buf.resize(bufSize);
+  string h=header(0);
+  if(!gz){
+    output(h.data(), h.size());
+    return !failed;
+  }
+  // first member: gzip header, one final stored block holding the header line, crc and size
+  unsigned char member[gzHeaderData] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3,
+                                         1, headerWidth & 0xff, headerWidth >> 8,
+                                         (unsigned char)(~headerWidth & 0xff), (unsigned char)((~headerWidth >> 8) & 0xff) };
+  output(member, gzHeaderData);
+  output(h.data(), h.size());
+  unsigned char trailer[8] = { 0 };
+  output(trailer, 8);
+  // second member: the clauses
+  memset(&zs, 0, sizeof(zs));
+  if(deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY)!=Z_OK){
+    cerr << "-E- Could not start the gzip stream of " << fileName << endl;
+    fclose(f);
+    f=NULL;
+    return false;
+  }
+  zbuf.resize(bufSize);
+  return !failed;
+}
+
+void clauseSink::flush(bool finish){
+  if(!gz){
+    output(&buf[0], used);
+    used=0;
+    return;
+  }
+  zs.next_in=(Bytef*)&buf[0];
+  zs.avail_in=used;
+  int r;
+  do {
+    zs.next_out=&zbuf[0];
+    zs.avail_out=zbuf.size();
+    r=deflate(&zs, finish ? Z_FINISH : Z_NO_FLUSH);
+    output(&zbuf[0], zbuf.size()-zs.avail_out);
+  } while(zs.avail_out==0 || zs.avail_in>0 || (finish && r!=Z_STREAM_END));
+  used=0;
+}
+
+// dimacs: variable+1, negative when inverted, 0 ends the clause
+void clauseSink::write(vec<Lit> &clause){
+  size_t need=12*(clause.size()+1);
+  if(used+need > buf.size()){
+    flush(false);
+    if(need > buf.size()) buf.resize(need);
+  }
+  char *p=&buf[used];
+  for(int k=0; k<clause.size(); k++){
+    if(sign(clause[k])) *p++='-';
+    unsigned int v=var(clause[k])+1;
+    char digits[12];
+    int n=0;
+    do {
+      digits[n++]='0'+v%10;
+      v/=10;
+    } while(v);
+    while(n) *p++=digits[--n];
+    *p++=' ';
+  }
+  *p++='0';
+  *p++='\n';
+  used=p-&buf[0];
+}
+
+void clauseSink::add(vec<Lit> &clause){
+  if(toSolver) S.addClause(clause);
+  fileOnly(clause);
+}
+
+void clauseSink::fileOnly(vec<Lit> &clause){
+  if(f) write(clause);
+  numClauses++;
+  clause.clear();
+}
+
+bool clauseSink::close(int nVars){
+  if(!f) return true;
+  flush(true);
+  if(gz) deflateEnd(&zs);
+  // the reserved header, in the first gzip member with its crc and size
+  string h=header(nVars);
+  if(fseek(f, gz ? gzHeaderData : 0, SEEK_SET)!=0) failed=true;
+  output(h.data(), h.size());
+  if(gz){
+    uLong crc=crc32(0L, (const Bytef*)h.data(), h.size());
+    unsigned char trailer[8];
+    for(int k=0; k<4; k++){
+      trailer[k]=(crc >> 8*k) & 0xff;
+      trailer[4+k]=(headerWidth >> 8*k) & 0xff;
+    }
+    output(trailer, 8);
+  }
+  if(fclose(f)!=0) failed=true;
+  f=NULL;
+  if(failed){
+    cerr << "-E- Could not write file:" << name << endl;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,65 @@
+#ifndef CLAUSE_SINK_H
+#define CLAUSE_SINK_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#define  __STDC_LIMIT_MACROS
+#define  __STDC_FORMAT_MACROS
+#include "core/Solver.h"
+
+/*
+  Every clause of the miter goes through one clauseSink: it is added to the
+  solver and, when a DIMACS file is open, formatted into a large buffer
+  written out in blocks (plain or gzip compressed). The "p cnf" header is
+  reserved at the start of the file with a fixed width and patched in place
+  by close(), once the number of variables and clauses is known.
+
+  A gzip file starts with a gzip member of its own holding only the header
+  as a stored (uncompressed) deflate block, so its bytes and CRC can be
+  patched too, the clauses follow as a second member (gzip readers and
+  zcat concatenate the members).
+*/
+
+class clauseSink {
+  public:
+    int numClauses;                   // clauses added (solver and/or file)
+
+    clauseSink(Minisat::Solver &solver);
+    ~clauseSink();
+
+    // start the DIMACS file, without it the clauses only reach the solver
+    bool open(const std::string &fileName, bool gzip);
+    bool isOpen() const { return f!=NULL; }
+
+    // add to the solver and the file, the clause is cleared
+    void add(Minisat::vec<Minisat::Lit> &clause);
+    // from now on add() writes the file only (the solver is not solved)
+    void solverOff() { toSolver=false; }
+    // add to the file only (a constraint the solver gets as an assumption instead)
+    void fileOnly(Minisat::vec<Minisat::Lit> &clause);
+
+    // flush and patch the header, returns false (after printing -E-) on a write error
+    bool close(int nVars);
+
+  private:
+    Minisat::Solver &S;
+    FILE *f;
+    std::string name;
+    bool gz;
+    z_stream zs;
+    std::vector<char> buf;            // formatted clauses
+    std::vector<unsigned char> zbuf;  // compressed output
+    size_t used;
+    bool failed;
+    bool toSolver;
+
+    void write(Minisat::vec<Minisat::Lit> &clause);
+    void flush(bool finish);
+    void output(const void *data, size_t size);
+    std::string header(int nVars) const;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include "coneCheck.h"
+
+#define  __STDC_LIMIT_MACROS
+#define  __STDC_FORMAT_MACROS
+#include "core/Solver.h"
+
+using namespace Minisat;
+using namespace std;
+
+static const int sliceConflicts = 1000; // conflicts between two checks of the timeout
+
+// one cone on its own solver, on the calling worker thread
+static void checkCone(const aigGraph &g, coneJob &job, double timeout){
+  chrono::steady_clock::time_point start=chrono::steady_clock::now();
+  vector<int> roots, cone;
+  roots.push_back(job.spec);
+  roots.push_back(job.imp);
+  aigCone(g, roots, cone);
+
+  Solver S;
+  // node -> solver variable, only for the nodes of the cone
+  unordered_map<int, int> satVar;
+  satVar.reserve(cone.size());
+  job.nodes=0;
+  for(size_t k=0; k<cone.size(); k++){
+    int n = cone[k];
+    satVar[n] = S.newVar();
+    if(n==0){
+      S.addClause(~mkLit(satVar[0]));
+    } else if(g.isAnd(n)){
+      // n = a & b
+      Lit x = mkLit(satVar[n]);
+      Lit a = mkLit(satVar[aigNode(g.fanin0[n])], aigCompl(g.fanin0[n]));
+      Lit b = mkLit(satVar[aigNode(g.fanin1[n])], aigCompl(g.fanin1[n]));
+      S.addClause(~x, a);
+      S.addClause(~x, b);
+      S.addClause(x, ~a, ~b);
+      job.nodes++;
+    }
+  }
+  // d = spec xor imp, solved under the assumption d
+  Lit a = mkLit(satVar[aigNode(job.spec)], aigCompl(job.spec));
+  Lit b = mkLit(satVar[aigNode(job.imp)], aigCompl(job.imp));
+  Lit d = mkLit(S.newVar());
+  S.addClause(~a, ~b, ~d);
+  S.addClause(a, b, ~d);
+  S.addClause(a, ~b, d);
+  S.addClause(~a, b, d);
+  vec<Lit> assumps;
+  assumps.push(d);
+
+  // slices of conflicts until solved or out of time, the learnt clauses carry over
+  lbool r = l_Undef;
+  while(true){
+    S.setConfBudget(sliceConflicts);
+    r = S.solveLimited(assumps);
+    job.sec=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+    if(r!=l_Undef || (timeout>0 && job.sec>=timeout)) break;
+  }
+  if(r==l_False){
+    job.verdict=CONE_EQUAL;
+  } else if(r==l_True){
+    job.verdict=CONE_DIFFERENT;
+    std::map<std::string, int>::const_iterator I;
+    for(I=g.inputs.begin(); I!=g.inputs.end(); I++){
+      unordered_map<int, int>::const_iterator V = satVar.find(aigNode(I->second));
+      if(V!=satVar.end()){
+        job.cex.push_back(std::make_pair(I->first, S.model[V->second]==l_True));
+      }
+    }
+  } else {
+    job.verdict=CONE_TIMEOUT;
+  }
+}
+
+int checkCones(const aigGraph &g, vector<coneJob> &jobs, int threads, double timeout){
+  if(threads<1) threads=1;
+  if((size_t)threads>jobs.size()) threads=jobs.size();
+  atomic<size_t> next(0);
+  auto worker=[&](){
+    for(size_t j=next++; j<jobs.size(); j=next++){
+      checkCone(g, jobs[j], timeout);
+    }
+  };
+  vector<thread> workers;
+  for(int t=1; t<threads; t++){
+    workers.push_back(thread(worker));
+  }
+  worker();
+  for(size_t t=0; t<workers.size(); t++){
+    workers[t].join();
+  }
+  int different=0;
+  for(size_t j=0; j<jobs.size(); j++){
+    if(jobs[j].verdict==CONE_DIFFERENT) different++;
+  }
+  return different;
+}
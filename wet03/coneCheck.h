@@ -0,0 +1,33 @@
+#ifndef CONE_CHECK_H
+#define CONE_CHECK_H
+
+#include <string>
+#include <vector>
+#include "aig.h"
+
+/*
+  Per-output equivalence checking (-parallel n).
+  Instead of one miter ORing every output XOR, each compared pair (output
+  port or dff input) is checked on its own: the cone of influence of the two
+  literals is encoded into a solver of its own and solved under the
+  assumption that they differ. The cones are handed out to n worker threads
+  over the shared, read-only AIG, so a hard output only holds its own thread
+  and every other verdict is still reported.
+*/
+
+enum coneVerdict { CONE_EQUAL, CONE_DIFFERENT, CONE_TIMEOUT };
+
+struct coneJob {
+  std::string name;                 // spec node name of the pair
+  int spec, imp;                    // literals of the pair
+  coneVerdict verdict;
+  double sec;
+  int nodes;                        // AND nodes in the cone
+  std::vector< std::pair<std::string, bool> > cex; // input values of a counter example (CONE_DIFFERENT)
+};
+
+// check every job on threads workers, timeout (seconds, 0 for none) per cone.
+// returns the number of cones proven different.
+int checkCones(const aigGraph &g, std::vector<coneJob> &jobs, int threads, double timeout);
+
+#endif
@@ -0,0 +1,348 @@
+#include <iostream>
+#include <unordered_map>
+#include "fraig.h"
+
+#define  __STDC_LIMIT_MACROS
+#define  __STDC_FORMAT_MACROS
+#include "core/Solver.h"
+
+using namespace Minisat;
+using namespace std;
+
+static const int initWords = 8;          // random pattern words before the first proof
+static const size_t simBudget = 1 << 24; // pattern words over all nodes (128 MB), caps the refinement words
+
+// xorshift64* random words
+static uint64_t nextRandom(uint64_t &s){
+  s ^= s >> 12;
+  s ^= s << 25;
+  s ^= s >> 27;
+  return s * 0x2545f4914f6cdd1dULL;
+}
+
+// signature hash of a class extended by one more (phase normalized) pattern word
+static uint64_t mixWord(uint64_t h, uint64_t w){
+  return (h ^ w) * 1099511628211ULL;
+}
+
+class sweeper {
+  public:
+    sweeper(aigGraph &g, int conflictLimit, int maxNodes, sweepStats &stats);
+    // literal of a new AND over literals of out, merged with a candidate when proven
+    int addAnd(int a, int b);
+    int addInput(const string &name);
+
+  private:
+    aigGraph &out;
+    int limit;
+    sweepStats &st;
+    uint64_t rng;
+    size_t maxWords;                    // no more refinement words past this, pairs are then left unmerged
+    vector< vector<uint64_t> > sim;     // word -> node -> 64 pattern values
+    vector<int> repr;                   // node -> literal it was merged into, its own literal otherwise
+    vector<int> satVar;                 // node -> solver variable, -1 before its clauses were added
+    // candidate classes: live nodes with the same signature (up to complement), oldest first
+    vector< vector<int> > members;      // class -> nodes
+    vector<uint64_t> classKey;          // class -> signature hash
+    unordered_map<uint64_t, int> classes; // signature hash -> class
+    // counter examples collected for the next pattern word
+    vector<uint64_t> cexWord;           // input node -> values of the collected counter examples
+    int cexCount;
+    Solver S;
+
+    bool phase(int node) const { return sim[0][node] & 1; }
+    uint64_t norm(int node, size_t w) const { return sim[w][node] ^ (phase(node) ? ~0ULL : 0); }
+    uint64_t signature(int node) const;
+    bool sameSignature(int a, int b) const;
+    void simulate(int node, size_t w);
+    int findClass(int node) const;
+    void newClass(int node, uint64_t key);
+    Lit satLit(int lit);
+    int prove(int a, int b);
+    void addCex();
+    void addWord();
+};
+
+sweeper::sweeper(aigGraph &g, int conflictLimit, int maxNodes, sweepStats &stats)
+  : out(g), limit(conflictLimit), st(stats), cexCount(0){
+  rng = 0x9e3779b97f4a7c15ULL;
+  maxWords = max((size_t)initWords+1, simBudget/max(maxNodes, 1));
+  sim.resize(initWords);
+  for(int w=0; w<initWords; w++){
+    sim[w].push_back(0);
+  }
+  repr.push_back(0);
+  cexWord.push_back(0);
+  // the constant: the candidate of every node simulating to all 0 or all 1
+  satVar.push_back(S.newVar());
+  S.addClause(~mkLit(satVar[0]));
+  newClass(0, signature(0));
+}
+
+// hash of the patterns, complemented when pattern 0 is 1 so a node and its inverse share it
+uint64_t sweeper::signature(int node) const{
+  uint64_t h = 14695981039346656037ULL;
+  for(size_t w=0; w<sim.size(); w++){
+    h = mixWord(h, norm(node, w));
+  }
+  return h;
+}
+
+bool sweeper::sameSignature(int a, int b) const{
+  for(size_t w=0; w<sim.size(); w++){
+    if(norm(a, w) != norm(b, w)) return false;
+  }
+  return true;
+}
+
+void sweeper::simulate(int node, size_t w){
+  int f0 = out.fanin0[node], f1 = out.fanin1[node];
+  uint64_t v0 = sim[w][aigNode(f0)] ^ (aigCompl(f0) ? ~0ULL : 0);
+  uint64_t v1 = sim[w][aigNode(f1)] ^ (aigCompl(f1) ? ~0ULL : 0);
+  sim[w][node] = v0 & v1;
+}
+
+// class of the nodes with the signature of node, -1 for none
+int sweeper::findClass(int node) const{
+  unordered_map<uint64_t, int>::const_iterator C = classes.find(signature(node));
+  if(C==classes.end() || !sameSignature(node, members[C->second][0])) return -1;
+  return C->second;
+}
+
+void sweeper::newClass(int node, uint64_t key){
+  classes[key] = members.size();
+  members.push_back(vector<int>(1, node));
+  classKey.push_back(key);
+}
+
+int sweeper::addInput(const string &name){
+  int lit = out.newInput(name);
+  for(size_t w=0; w<sim.size(); w++){
+    sim[w].push_back(nextRandom(rng));
+  }
+  repr.push_back(lit);
+  satVar.push_back(-1);
+  cexWord.push_back(nextRandom(rng));
+  int c = findClass(aigNode(lit));
+  if(c<0){
+    newClass(aigNode(lit), signature(aigNode(lit)));
+  } else {
+    members[c].push_back(aigNode(lit));
+  }
+  return lit;
+}
+
+// solver literal of a literal of out, adding the clauses of its cone first
+Lit sweeper::satLit(int lit){
+  vector<int> stack;
+  stack.push_back(aigNode(lit));
+  while(!stack.empty()){
+    int n = stack.back();
+    if(satVar[n]>=0){
+      stack.pop_back();
+      continue;
+    }
+    if(!out.isAnd(n)){
+      satVar[n]=S.newVar();
+      stack.pop_back();
+      continue;
+    }
+    int a = aigNode(out.fanin0[n]), b = aigNode(out.fanin1[n]);
+    if(satVar[a]<0 || satVar[b]<0){
+      if(satVar[a]<0) stack.push_back(a);
+      if(satVar[b]<0) stack.push_back(b);
+      continue;
+    }
+    satVar[n]=S.newVar();
+    Lit x = mkLit(satVar[n]);
+    Lit la = mkLit(satVar[a], aigCompl(out.fanin0[n]));
+    Lit lb = mkLit(satVar[b], aigCompl(out.fanin1[n]));
+    S.addClause(~x, la);
+    S.addClause(~x, lb);
+    S.addClause(x, ~la, ~lb);
+    stack.pop_back();
+  }
+  return mkLit(satVar[aigNode(lit)], aigCompl(lit));
+}
+
+/*
+  a == b ? both differences are asked under assumptions, a proven pair is
+  added as clauses so the later proofs use it.
+  Returns 1 equal, 0 different (the model is the counter example), -1 over the limit.
+*/
+int sweeper::prove(int a, int b){
+  Lit la = satLit(a), lb = satLit(b);
+  for(int k=0; k<2; k++){
+    vec<Lit> assumps;
+    assumps.push(k ? ~la : la);
+    assumps.push(k ? lb : ~lb);
+    st.proofs++;
+    S.setConfBudget(limit);
+    lbool r = S.solveLimited(assumps);
+    if(r==l_True) return 0;
+    if(r==l_Undef) return -1;
+  }
+  S.budgetOff();
+  S.addClause(~la, lb);
+  S.addClause(la, ~lb);
+  return 1;
+}
+
+// the counter example in the model becomes the next pattern of cexWord,
+// inputs out of the solved cones keep their random value
+void sweeper::addCex(){
+  uint64_t bit = 1ULL << cexCount++;
+  for(size_t n=1; n<cexWord.size(); n++){
+    if(out.isAnd(n) || satVar[n]<0 || satVar[n]>=S.model.size()) continue;
+    if(S.model[satVar[n]]==l_True){
+      cexWord[n] |= bit;
+    } else {
+      cexWord[n] &= ~bit;
+    }
+  }
+}
+
+/*
+  64 counter examples collected: they are simulated as one new pattern word
+  over the live nodes and every class the word splits is re-split, each part
+  under the signature extended by its value of the word. A class the word
+  does not split keeps its members under the extended signature.
+*/
+void sweeper::addWord(){
+  size_t w = sim.size();
+  sim.push_back(vector<uint64_t>(out.numNodes(), 0));
+  for(int n=1; n<out.numNodes(); n++){
+    if(!out.isAnd(n)){
+      sim[w][n] = cexWord[n];
+      cexWord[n] = nextRandom(rng);
+    } else if(repr[n]==2*n){
+      simulate(n, w);
+    }
+  }
+  cexCount = 0;
+  classes.clear();
+  size_t numClasses = members.size();
+  for(size_t c=0; c<numClasses; c++){
+    uint64_t key = classKey[c];
+    vector<int> rest;
+    uint64_t v = norm(members[c][0], w);
+    for(size_t m=0; m<members[c].size(); m++){
+      if(norm(members[c][m], w)!=v) rest.push_back(members[c][m]);
+    }
+    if(!rest.empty()){
+      vector<int> keep;
+      for(size_t m=0; m<members[c].size(); m++){
+        if(norm(members[c][m], w)==v) keep.push_back(members[c][m]);
+      }
+      members[c].swap(keep);
+    }
+    classKey[c] = mixWord(key, v);
+    classes[classKey[c]] = c;
+    // the other values of the word, one new class each
+    while(!rest.empty()){
+      uint64_t r = norm(rest[0], w);
+      vector<int> part, left;
+      for(size_t m=0; m<rest.size(); m++){
+        (norm(rest[m], w)==r ? part : left).push_back(rest[m]);
+      }
+      classes[mixWord(key, r)] = members.size();
+      members.push_back(part);
+      classKey.push_back(mixWord(key, r));
+      rest.swap(left);
+    }
+  }
+}
+
+/*
+  The new node is proven against the members of its class in turn. A
+  counter example rules out every other member whose value in the model
+  differs as well (their clauses are in the solver, so the model holds their
+  value for the counter example) and is kept for the next pattern word; the
+  node joins its class unmerged. With 64 counter examples collected the word
+  is simulated and the node looks up its (refined) class again.
+*/
+int sweeper::addAnd(int a, int b){
+  int lit = out.And(a, b);
+  int n = aigNode(lit);
+  if(n<(int)repr.size()){
+    // found in the structural hash (or a constant / input): already swept
+    return repr[n] ^ aigCompl(lit);
+  }
+  for(size_t w=0; w<sim.size(); w++){
+    sim[w].push_back(0);
+    simulate(n, w);
+  }
+  repr.push_back(2*n);
+  satVar.push_back(-1);
+  cexWord.push_back(0);
+  int c;
+  bool refined = true;
+  while(refined && (c = findClass(n))>=0){
+    refined = false;
+    vector<char> ruledOut(members[c].size(), 0);
+    for(size_t m=0; m<members[c].size(); m++){
+      if(ruledOut[m]) continue;
+      int cand = 2*members[c][m] ^ (phase(n)!=phase(members[c][m]));
+      int r = prove(2*n, cand);
+      if(r==1){
+        st.merged++;
+        repr[n]=cand;
+        return repr[n] ^ aigCompl(lit);
+      }
+      if(r<0){
+        // hard pair, the node is left out of the classes
+        st.undecided++;
+        return repr[n] ^ aigCompl(lit);
+      }
+      st.cexs++;
+      bool vn = S.model[satVar[n]]==l_True;
+      for(size_t k=m+1; k<members[c].size(); k++){
+        int v = satVar[members[c][k]];
+        if(v>=0 && v<S.model.size() &&
+           ((S.model[v]==l_True) ^ (phase(n)!=phase(members[c][k])))!=vn){
+          ruledOut[k]=1;
+        }
+      }
+      if(sim.size()<maxWords){
+        addCex();
+        if(cexCount==64){
+          addWord();
+          refined = true;
+          break;
+        }
+      }
+    }
+  }
+  if(c<0){
+    newClass(n, signature(n));
+  } else {
+    members[c].push_back(n);
+  }
+  return repr[n] ^ aigCompl(lit);
+}
+
+/*
+  The inputs keep their names and order. An AND of g is rebuilt over the
+  swept literals of its inputs, so a node merged into its candidate is never
+  seen again by its fanout.
+*/
+void aigSweep(const aigGraph &g, aigGraph &out, vector<int> &lits, int conflictLimit, sweepStats &stats){
+  sweeper sw(out, conflictLimit, g.numNodes(), stats);
+  lits.assign(g.numNodes(), 0);
+  for(int n=1; n<g.numNodes(); n++){
+    if(g.isAnd(n)){
+      int a = lits[aigNode(g.fanin0[n])] ^ aigCompl(g.fanin0[n]);
+      int b = lits[aigNode(g.fanin1[n])] ^ aigCompl(g.fanin1[n]);
+      lits[n] = sw.addAnd(a, b);
+    } else {
+      lits[n] = sw.addInput(g.names[n]);
+    }
+  }
+  std::map<std::string, int>::const_iterator I;
+  for(I=g.inputs.begin(); I!=g.inputs.end(); I++){
+    out.inputs[I->first] = lits[aigNode(I->second)];
+  }
+  for(I=g.states.begin(); I!=g.states.end(); I++){
+    out.states[I->first] = lits[aigNode(I->second)];
+  }
+}
@@ -0,0 +1,36 @@
+#ifndef FRAIG_H
+#define FRAIG_H
+
+#include <vector>
+#include "aig.h"
+
+/*
+  SAT sweeping (fraiging) of the shared AIG.
+  The graph is rebuilt node by node in topological order. Every new node is
+  random simulated with bit-parallel patterns (64 per word) and its signature,
+  up to complement, selects a candidate: an earlier node or the constant with
+  the same signature. The pair is proven with an incremental solver holding
+  the clauses of the rebuilt graph, a proven node is replaced by its
+  candidate so every later node (and the proof of it) is built over the
+  merged graph. Counter examples are collected 64 at a time into one new
+  pattern word, simulated once over the graph, which only re-splits the
+  candidate classes it separates. The number of pattern words is capped by
+  the size of the graph.
+*/
+
+class sweepStats {
+  public:
+    int merged;     // nodes replaced by an equivalent earlier node or constant
+    int proofs;     // SAT calls
+    int cexs;       // candidates disproven by a counter example
+    int undecided;  // candidates left when the conflict limit was reached
+    sweepStats() : merged(0), proofs(0), cexs(0), undecided(0) {}
+};
+
+/*
+  Sweep g into out. lits gets, for every node of g, its literal in out.
+  conflictLimit bounds every SAT call, a pair over the limit is not merged.
+*/
+void aigSweep(const aigGraph &g, aigGraph &out, std::vector<int> &lits, int conflictLimit, sweepStats &stats);
+
+#endif
@@ -4,9 +4,16 @@
 #include <fstream>
 #include "hcm.h"
 #include "flat.h"
+#include "cellLib.h"
+#include "aig.h"
+#include "fraig.h"
+#include "coneCheck.h"
+#include "clauseSink.h"
 #include <iostream>
 #include <string> 
 #include <sstream>
+#include <algorithm>
+#include <chrono>
 
 #define  __STDC_LIMIT_MACROS
 #define  __STDC_FORMAT_MACROS
@@ -20,21 +27,30 @@ using namespace Minisat;
 using namespace std;
 
 bool verbose = false;
+bool sweeping = true;          // SAT sweeping of the AIG before the miter (-nosweep: one monolithic miter)
+int sweep_conflicts = 1000;    // conflict limit of every SAT sweeping proof
+int cone_threads = 0;          // -parallel n: every compared pair on its own solver, n threads (0: one miter)
+double cone_timeout = 0;       // -timeout sec: time limit of each cone in -parallel, 0 for none
+bool write_cnf = true;         // -nocnf: clauses only to the solver
+bool gzip_cnf = false;         // -gzip: spec-cell.cnf.gz
 
 ///////////////////////////////////////////////////////////////////////////
 
 /* functions declarations */
-void Instance_Add_Clauses(hcmInstance* inst,Solver &S,ofstream& file,int &num_clauses);
-bool compatible_cells(hcmCell *flatCell_spec,hcmCell *flatCell_imp, 
+Lit aig_lit(int lit,vector<int> &aig_var);
+void AIG_Add_Clauses(aigGraph &aig,vector<int> &aig_var,vector<int> &cone,clauseSink &sink);
+void logic_XOR2(Lit a,Lit b,Lit c,clauseSink &sink);
+bool compatible_cells(cellLibrary &lib,hcmCell *flatCell_spec,hcmCell *flatCell_imp, 
   std::map< hcmNode*, hcmNode* > &outputs_cells,std::map< hcmInstance*, hcmInstance* > &dff_cells);
 void add_dffs_to_map(hcmInstance* spec_inst,hcmInstance* imp_inst,std::map< hcmNode*, hcmNode* > &outputs_cells);
-void XOR_outputs(std::map< hcmNode*, hcmNode* > &outputs_cells,Solver &S,ofstream& file,int &num_clauses);
+void XOR_outputs(vector< std::pair<Lit,Lit> > &outputs,vector<int> &XOR_results,Solver &S,clauseSink &sink);
 
 /* implementation in the end  */
 
 int main(int argc, char **argv) {
   int argIdx = 1;
   int anyErr = 0;
+  bool timeoutGiven = false;      // -timeout was given (it needs -parallel)
 
   vector<string> specFiles;
   vector<string> implementFiles;
@@ -43,9 +59,29 @@ int main(int argc, char **argv) {
     anyErr++;
   } 
   else {
-    if (!strcmp(argv[argIdx], "-v")) {
-          argIdx++;
-          verbose = true;
+    while (argIdx < argc && strcmp(argv[argIdx], "-s") && argv[argIdx][0]=='-') {
+      if (!strcmp(argv[argIdx], "-v")) {
+        verbose = true;
+      } else if (!strcmp(argv[argIdx], "-nosweep")) {
+        sweeping = false;
+      } else if (!strcmp(argv[argIdx], "-parallel") && argIdx+1 < argc) {
+        cone_threads = atoi(argv[++argIdx]);
+        if (cone_threads < 1) {
+          cerr << "-E- -parallel needs a number of threads" << endl;
+          anyErr++;
+        }
+      } else if (!strcmp(argv[argIdx], "-timeout") && argIdx+1 < argc) {
+        cone_timeout = atof(argv[++argIdx]);
+        timeoutGiven = true;
+      } else if (!strcmp(argv[argIdx], "-nocnf")) {
+        write_cnf = false;
+      } else if (!strcmp(argv[argIdx], "-gzip")) {
+        gzip_cnf = true;
+      } else {
+        cerr << "-E- unknown option " << argv[argIdx] << endl;
+        anyErr++;
+      }
+      argIdx++;
     }
     if (!strcmp(argv[argIdx], "-s")) {
       argIdx++;
@@ -78,10 +114,14 @@ int main(int argc, char **argv) {
       cerr << "-E- missing `-s` in the command line" << endl;
       anyErr++;
     }
-    
+    // the single miter solve has no time budget
+    if (timeoutGiven && !cone_threads) {
+      cerr << "-E- -timeout limits the cones of -parallel only" << endl;
+      anyErr++;
+    }
   }
   if (anyErr) {
-    cerr << "Usage: " << argv[0] << "  [-v] -s spec-cell verilog1 [verilog2...] -i implemenattion-cell verilog1 [verilog2...] \n" ;
+    cerr << "Usage: " << argv[0] << "  [-v] [-nosweep] [-parallel threads [-timeout sec]] [-nocnf | -gzip] -s spec-cell verilog1 [verilog2...] -i implemenattion-cell verilog1 [verilog2...] \n" ;
     exit(1);
   }
   
@@ -125,10 +165,11 @@ int main(int argc, char **argv) {
   }
 
   /*direct to file*/
-  string fileName = specFiles[0] + string(".cnf");
-  ofstream cnf_file(fileName.c_str());
-  if (!cnf_file.good()) {
-    cerr << "-E- Could not open file:" << fileName << endl;
+  // every clause goes to the solver and (unless -nocnf) to the cnf file through the sink
+  Solver S;
+  clauseSink sink(S);
+  string fileName = specFiles[0] + string(gzip_cnf ? ".cnf.gz" : ".cnf");
+  if (write_cnf && !sink.open(fileName, gzip_cnf)) {
     exit(1);
   }
 
@@ -145,45 +186,28 @@ int main(int argc, char **argv) {
   std::map< hcmInstance*, hcmInstance* > dff_cells; // first - spec dff , second - implementation dff.
 
   // check if cells are compatible for FEV, and if so push all output ports to the above map
-  bool compatible = compatible_cells(flatCell_spec,flatCell_imp,outputs_cells,dff_cells);
+  // master cell descriptors (function, pin order), resolved once per cell
+  cellLibrary lib;
+  bool compatible = compatible_cells(lib,flatCell_spec,flatCell_imp,outputs_cells,dff_cells);
   if(!compatible){
-    cnf_file <<"p cnf 1 1"<<endl;
-    cnf_file <<"1 0"<<endl; //will return sat
-    cnf_file.close();
+    vec<Lit> clause;
+    clause.push(mkLit(0));
+    sink.fileOnly(clause); //will return sat
+    sink.close(1);
     cerr<<"-E Cells aren't compatible for FEV (different cells)" <<endl;
     exit(1);
   }
 
-  string tempFilename = string("temp_file.txt"); //temporary axuiliary file, later it will be deleted
-  ofstream temp_file(tempFilename.c_str());
-  if (!temp_file.good()) {
-    cerr << "-E- Could not open file:" << tempFilename << endl;
+  // Both cells into one And-Inverter Graph: inputs with the same name and the
+  // outputs of DFFs with the same name are the same AIG inputs, VDD/VSS are
+  // propagated as constants and structural hashing merges the logic the cells share.
+  aigGraph aig;
+  std::map< hcmNode*, int > spec_lits, imp_lits; // node -> AIG literal
+  if(!aigAddCell(aig,lib,flatCell_spec,spec_lits) || !aigAddCell(aig,lib,flatCell_imp,imp_lits)){
     exit(1);
   }
-  // introduce a number for each node (0,1,2,3...) for the SPEC cell
-  std::map< std::string, hcmNode* >::const_iterator nI;
-  std::map< std::string, hcmNode* > spec_nodes = flatCell_spec->getNodes();
-  int var_num=0, num_nodes=spec_nodes.size();
-  int vdd_num = num_nodes-1, vss_num= num_nodes-2;
-
-  for (nI =spec_nodes.begin(); nI != spec_nodes.end(); nI++){
-    hcmNode *node= nI->second;   
-    if(node->getName()=="VDD"){
-      node->setProp("variable_num",vdd_num);  
-    }
-    else if(node->getName()=="VSS"){ 
-      node->setProp("variable_num",vss_num); 
-    }
-    else{
-      int t;
-      node->setProp("variable_num",var_num); 
-      var_num++;
-    }
-  }
-  
-  //Adding inputs nodes of the same DFF to the outputs map,
-  //and update implementation variable number of dff outputs
-  //(we want dff outputs of both cells to have the same variable numbering).
+
+  //Adding inputs nodes of the same DFF to the outputs map.
   std::map< hcmInstance*, hcmInstance* >::const_iterator it_dff;
   for(it_dff=dff_cells.begin(); it_dff!=dff_cells.end(); it_dff++){
     hcmInstance* inst_spec = it_dff->first;
@@ -191,217 +215,254 @@ int main(int argc, char **argv) {
     add_dffs_to_map(inst_spec,inst_imp,outputs_cells);
   }
 
-  // At the IMPLEMENTATION cell, match common nodes from the SPEC cell
-  // and introduce new numbers for non-input nodes (and non-DFF output).
-  // note that for input node (or output of DFF) which we've already created a variable
-  // in the SPEC cell ,we gave the same variable numeber.
-  // Note, if DFF outputs connect directly to an output port, we give the same numbering for both designs outputs,
-  // because it will not lead to SAT anyway. (we could have named them differently, but it doesn't matter).
-  var_num=num_nodes;
-  std::map< std::string, hcmNode* > imp_nodes = flatCell_imp->getNodes();
-  for (nI =imp_nodes.begin(); nI != imp_nodes.end(); nI++){
-    hcmNode *node= nI->second;
-    int t;
-    int found = node->getProp("variable_num",t);
-    if(found!=NOT_FOUND){ // already gave a value for DFFs outputs (the same in both cells) 
-      continue;
-    }
-    string node_name=node->getName();
-    if(node_name=="VSS" || node_name=="VDD"){
-      int glob = vss_num+(node_name=="VDD");
-      node->setProp("variable_num",glob);
-      continue;
-    }
-    hcmPort *port = node->getPort();
-    if(port && port->getDirection()==IN){
-      hcmNode *node_from_spec = flatCell_spec->getNode(node_name);
-      if(node_from_spec){  // a variable with the same name exist in the spec_cell
-        int temp=0;
-        node_from_spec->getProp("variable_num",temp);
-        node->setProp("variable_num",temp);
-      }
-      else{
-        node->setProp("variable_num",var_num); 
-        var_num++;
-      } 
+  // SAT sweeping: internal equivalences found by random simulation are proven
+  // from the inputs to the outputs and merged, the miter is built over the swept AIG
+  aigGraph swept;
+  vector<int> swept_lits;
+  sweepStats sweep;
+  if(sweeping){
+    aigSweep(aig,swept,swept_lits,sweep_conflicts,sweep);
+  }
+  aigGraph &miter_aig = sweeping ? swept : aig;
+
+  // outputs which hashed (or were swept) to the same literal are equal by construction,
+  // only the others go to the miter
+  vector< std::pair<int,int> > compared;
+  vector<string> compared_names, equal_names;
+  int equal_outputs=0;
+  std::map< hcmNode*, hcmNode* >::const_iterator oI;
+  for(oI =outputs_cells.begin(); oI != outputs_cells.end(); oI++){
+    int a = spec_lits[oI->first], b = imp_lits[oI->second];
+    if(sweeping){
+      a = swept_lits[aigNode(a)] ^ aigCompl(a);
+      b = swept_lits[aigNode(b)] ^ aigCompl(b);
     }
-    else{
-      node->setProp("variable_num",var_num); 
-      var_num++;
+    if(a==b){
+      equal_outputs++;
+      equal_names.push_back(oI->first->getName());
+    } else {
+      compared.push_back(std::pair<int,int>(a,b));
+      compared_names.push_back(oI->first->getName());
     }
-   
-  } 
-  // print the variables mapping for convinience (numbers 1,2,3...), and create dict to get name of input from number
-  // comment out the comments to print also the variable mapping.
-  // cout<<"\nVariable mapping for each cell :"<<endl;
-  // cout << " ---- SPEC cell : " <<endl;
+  }
+
+  // the miter: with -parallel every pair is solved on a solver of its own,
+  // so it is only encoded for the cnf file (and skipped without one)
   std::map<int, string> input_var_to_name;
-  for (nI =spec_nodes.begin(); nI != spec_nodes.end(); nI++){
-    hcmNode *node= nI->second;
-    int temp=0;
-    node->getProp("variable_num",temp); 
-    string name = node->getName();
-    // cout<<name<< " = " <<temp+1 <<endl;
-    hcmPort *port = node->getPort();
-    if(port && port->getDirection()==IN){
-      input_var_to_name.insert(std::pair<int, string>(temp,name));
+  vector<int> XOR_results; // XOR output of each compared pair, its activation literal
+  bool miter = !cone_threads || sink.isOpen();
+  if(cone_threads){
+    sink.solverOff();
+  }
+  if(miter){
+    // a variable for every input first (the counter example is printed from them),
+    // then for the AIG nodes in the cone of the compared outputs
+    vector<int> aig_var(miter_aig.numNodes(), -1);
+    std::map< std::string, int >::const_iterator inI;
+    for(inI=miter_aig.inputs.begin(); inI!=miter_aig.inputs.end(); inI++){
+      int v = S.newVar();
+      aig_var[aigNode(inI->second)] = v;
+      input_var_to_name.insert(std::pair<int, string>(v,inI->first));
+    }
+    vector<int> roots, cone;
+    for(size_t k=0; k<compared.size(); k++){
+      roots.push_back(compared[k].first);
+      roots.push_back(compared[k].second);
+    }
+    aigCone(miter_aig,roots,cone);
+    for(size_t k=0; k<cone.size(); k++){
+      if(aig_var[cone[k]]<0){
+        aig_var[cone[k]] = S.newVar();
+      }
     }
-  } 
-  // cout << " ---- IMPLEMENTATION cell : " <<endl;
-  for (nI =imp_nodes.begin(); nI != imp_nodes.end(); nI++){
-    hcmNode *node= nI->second;
-    int temp=0;
-    node->getProp("variable_num",temp); 
-    string name = node->getName();
-    // cout<<name<< " = " <<temp+1 <<endl;
-    hcmPort *port = node->getPort();
-    if(port && port->getDirection()==IN){
-      input_var_to_name.insert(std::pair<int, string>(temp,name));
-    } 
-  } 
-  cout <<" "<<endl;
 
-  Solver S;
-  // Declare all the variables (which is currently var_num-1 vars)
-  for(int i=0;i<var_num;i++){
-    S.newVar();
-  }
-  // Forcing VDD=1 , VSS=0
-  S.addClause(~mkLit(vss_num));
-  S.addClause(mkLit(vdd_num));
-  temp_file<<-(vss_num+1)<< " 0" <<endl;
-  temp_file<<(vdd_num+1)<< " 0" <<endl;
+    //number of variable is the cone + number of outputs +1 (we will introduce new variable later for each xor of outputs and for the OR between all XORs)
 
-  //number of variable is var_num + number of outputs +1 (we will introduce new variable later for each xor of outputs and for the OR between all XORs)
+    // Forcing the constant node (only in the cone when an output is VDD/VSS) to 0
+    if(!cone.empty() && cone[0]==0){
+      vec<Lit> clause;
+      clause.push(~mkLit(aig_var[0]));
+      sink.add(clause);
+    }
 
-  int num_clauses= 2; // 2 for VDD and VSS clauses
+    // creating the tsyitin clauses of each AND node in the cone
+    AIG_Add_Clauses(miter_aig,aig_var,cone,sink);
 
-  // creating appropriate tsyitin clauses to each instance in each of the cells
-  std::map< std::string, hcmInstance* >::const_iterator iI;
-  std::map< std::string, hcmInstance* > instances_spec = flatCell_spec->getInstances();
-  for(iI =instances_spec.begin(); iI != instances_spec.end(); iI++){
-    hcmInstance* inst= iI->second;
-    Instance_Add_Clauses(inst,S,temp_file,num_clauses);
-  }
-  std::map< std::string, hcmInstance* > instances_imp = flatCell_imp->getInstances();
-  for(iI =instances_imp.begin(); iI != instances_imp.end(); iI++){
-    hcmInstance* inst= iI->second;
-    Instance_Add_Clauses(inst,S,temp_file,num_clauses);
+    // Adding appropriate tsyitin clauses to each output (including DFF inputs)
+    // in other words: xor clause between appropriate outputs (DFF inputs as well)
+    vector< std::pair<Lit,Lit> > compared_lits;
+    for(size_t k=0; k<compared.size(); k++){
+      compared_lits.push_back(std::pair<Lit,Lit>(aig_lit(compared[k].first,aig_var),aig_lit(compared[k].second,aig_var)));
+    }
+    XOR_outputs(compared_lits,XOR_results,S,sink);
   }
- 
-  // Adding appropriate tsyitin clauses to each output (including DFF inputs)
-  // in other words: xor clause between appropriate outputs (DFF inputs as well)
-  XOR_outputs(outputs_cells,S,temp_file,num_clauses);
   cout << "Statistics:  "<<endl;
-  cout << "   Number of clauses (before simplification):  " <<num_clauses <<endl;
+  int and_nodes=0;
+  for(int n=0; n<aig.numNodes(); n++){
+    if(aig.isAnd(n)) and_nodes++;
+  }
+  cout << "   AIG nodes:  " <<and_nodes <<" (" <<aig.hashHits <<" merged by structural hashing)" <<endl;
+  if(sweeping){
+    cout << "   SAT sweeping:  " <<sweep.merged <<" nodes merged (" <<sweep.proofs <<" SAT calls, "
+         <<sweep.cexs <<" counter examples, " <<sweep.undecided <<" over the conflict limit)" <<endl;
+  }
+  cout << "   Outputs equal by structure:  " <<equal_outputs <<" of " <<outputs_cells.size() <<endl;
+  if(miter){
+    cout << "   Number of clauses (before simplification):  " <<sink.numClauses <<endl;
+    cout << "   Number of variables:  " <<S.nVars() <<endl;
+  }
+  cout <<endl;
   int nVars= S.nVars();
-  cout << "   Number of variables:  " <<S.nVars() <<"\n"<<endl;
 
 
   cout << "Result:  "<<endl;
-  // solve with minisat
-  S.simplify();
-  bool sat = S.solve();
-  if(sat){
-    cout << " -- SATISFIABLE - The circuits are different!" <<endl;
-    cout << "Input assignment :" <<endl;
-    std::map< int, string >::const_iterator inpuI;
-    // printing the outputs assignment if SAT
-    for(inpuI=input_var_to_name.begin(); inpuI!=input_var_to_name.end();inpuI++){
-      string input_name = inpuI->second;
-      int i = inpuI->first;
-      cout << input_name;
-      printf(" = %s\n", (S.model[i]== l_Undef) ? "undef" : ((S.model[i]== l_True) ? "+" : "-"));
+  if(cone_threads){
+    // every compared pair on its own solver, the miter above only went to the cnf file
+    vector<coneJob> jobs(compared.size());
+    for(size_t k=0; k<compared.size(); k++){
+      jobs[k].name = compared_names[k];
+      jobs[k].spec = compared[k].first;
+      jobs[k].imp = compared[k].second;
+    }
+    int different = checkCones(miter_aig,jobs,cone_threads,cone_timeout);
+    int timeouts = 0;
+    for(size_t k=0; k<equal_names.size(); k++){
+      cout << "   " << equal_names[k] << " -- equal by structure" <<endl;
+    }
+    for(size_t k=0; k<jobs.size(); k++){
+      const char *verdict = jobs[k].verdict==CONE_EQUAL ? "UNSAT - equivalent" :
+                            jobs[k].verdict==CONE_DIFFERENT ? "SATISFIABLE - different" : "TIMEOUT";
+      printf("   %s -- %s (%d nodes, %.3f sec)\n", jobs[k].name.c_str(), verdict, jobs[k].nodes, jobs[k].sec);
+      if(jobs[k].verdict==CONE_TIMEOUT) timeouts++;
+    }
+    if(different){
+      cout << " -- SATISFIABLE - The circuits are different! (" << different << " outputs)" <<endl;
+      for(size_t k=0; k<jobs.size(); k++){
+        if(jobs[k].verdict!=CONE_DIFFERENT) continue;
+        // counter example of the first different output
+        cout << "Input assignment (" << jobs[k].name << ") :" <<endl;
+        for(size_t i=0; i<jobs[k].cex.size(); i++){
+          cout << jobs[k].cex[i].first;
+          printf(" = %s\n", jobs[k].cex[i].second ? "+" : "-");
+        }
+        break;
+      }
+    } else if(timeouts){
+      cout << " -- UNKNOWN - " << timeouts << " outputs timed out" <<endl;
+    } else {
+      cout << " -- UNSAT - The circuits are eqeuivalent" <<endl;
+    }
+  } else {
+    /*
+      solve with minisat, one output at a time in the same solver: the XOR output
+      of the pair is the activation literal passed to solve(assumptions), so the
+      clauses learnt on one output serve the next ones, and an output proven
+      equivalent is added as the lemma ~XOR for the outputs after it.
+      The pairs go from the inputs towards the outputs (by their deepest node).
+    */
+    vector<size_t> order;
+    for(size_t k=0; k<compared.size(); k++){
+      order.push_back(k);
+    }
+    std::sort(order.begin(), order.end(), [&](size_t x, size_t y){
+      return std::max(aigNode(compared[x].first),aigNode(compared[x].second)) <
+             std::max(aigNode(compared[y].first),aigNode(compared[y].second));
+    });
+    for(size_t k=0; k<equal_names.size(); k++){
+      cout << "   " << equal_names[k] << " -- equal by structure" <<endl;
+    }
+    S.simplify();
+    int different=0;
+    vec<lbool> cex;
+    string cex_name;
+    for(size_t i=0; i<order.size(); i++){
+      size_t k=order[i];
+      Lit act = mkLit(XOR_results[k]);
+      chrono::steady_clock::time_point start=chrono::steady_clock::now();
+      bool sat = S.solve(act);
+      double sec=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+      printf("   %s -- %s (%.3f sec)\n", compared_names[k].c_str(), sat ? "SATISFIABLE - different" : "UNSAT - equivalent", sec);
+      if(sat){
+        if(!different){
+          S.model.copyTo(cex);
+          cex_name = compared_names[k];
+        }
+        different++;
+      } else {
+        S.addClause(~act);
+      }
     }
-  } 
-  else{
-    cout << " -- UNSAT - The circuits are eqeuivalent" <<endl;
-  }
-  
-  //first line in cnf file
-  cnf_file << "p cnf "<< nVars << " "<< num_clauses <<endl;
-  // copying the clauses in temp_file to cnf_file
-  ifstream temp_f(tempFilename.c_str());
-  std::string line;
-  if(temp_f && cnf_file){
-    while(getline(temp_f,line)){
-        cnf_file << line << "\n";
+    if(different){
+      cout << " -- SATISFIABLE - The circuits are different! (" << different << " outputs)" <<endl;
+      cout << "Input assignment (" << cex_name << ") :" <<endl;
+      std::map< int, string >::const_iterator inpuI;
+      // printing the outputs assignment if SAT
+      for(inpuI=input_var_to_name.begin(); inpuI!=input_var_to_name.end();inpuI++){
+        string input_name = inpuI->second;
+        int i = inpuI->first;
+        cout << input_name;
+        printf(" = %s\n", (cex[i]== l_Undef) ? "undef" : ((cex[i]== l_True) ? "+" : "-"));
+      }
+    } 
+    else{
+      cout << " -- UNSAT - The circuits are eqeuivalent" <<endl;
     }
-  } 
-
-  if(cnf_file.is_open()) cnf_file.close();
-  if(temp_file.is_open()) temp_file.close();
-  temp_f.close();
+  }
 
-  remove(tempFilename.c_str()); //remove the temporary file
+  // the "p cnf" header is patched in place once the file is complete
+  if(!sink.close(nVars)){
+    exit(1);
+  }
   return(0);
 }
 
 // Function's implementations
 
+// solver literal of an AIG literal
+Lit aig_lit(int lit,vector<int> &aig_var){
+  return mkLit(aig_var[aigNode(lit)], aigCompl(lit));
+}
+
 /*
   Add xor clauses between outputs of cells, add introduce new variable as output
   of the xor. 
   In addition we add  more clause with OR of all the XOR outputs (as if one of them is 1 the problem is SAT).
-  And one more clause to force the result of OR to be 1 (as shown in class).
+  And one more clause to force the result of OR to be 1 (as shown in class), only in the cnf
+  file: the solver checks one output at a time with its XOR output as the assumption.
 */
-void XOR_outputs(std::map< hcmNode*, hcmNode* > &outputs_cells,Solver &S,ofstream& file,int &num_clauses){
-  std::map< hcmNode*, hcmNode* >::const_iterator I;
-  vector<int> XOR_results;
-  for(I =outputs_cells.begin(); I != outputs_cells.end(); I++){
-    hcmNode* spec_node = I->first;
-    hcmNode* imp_node = I->second;
+void XOR_outputs(vector< std::pair<Lit,Lit> > &outputs,vector<int> &XOR_results,Solver &S,clauseSink &sink){
+  for(size_t k=0; k<outputs.size(); k++){
     int v = S.newVar();
     XOR_results.push_back(v);
-    int a,b;
-    spec_node->getProp("variable_num",a);
-    imp_node->getProp("variable_num",b);
-
     // v = a xor b   clause
-    S.addClause(~mkLit(a),~mkLit(b),~mkLit(v)); // (~A+ ~B+ ~V)
-    S.addClause(mkLit(a),mkLit(b),~mkLit(v)); // (A+ B+ ~V)
-    S.addClause(mkLit(a),~mkLit(b),mkLit(v)); // (A+ ~B+ V)
-    S.addClause(~mkLit(a),mkLit(b),mkLit(v)); // (~A+ B+ V)
-    file << -(a+1) <<" "<<-(b+1) << " " << -(v+1)<<" 0" <<endl;
-    file << (a+1) <<" "<<(b+1) << " " << -(v+1)<<" 0" <<endl;
-    file << (a+1) <<" "<<-(b+1) << " " << (v+1)<<" 0" <<endl;
-    file << -(a+1) <<" "<<(b+1) << " " << (v+1)<<" 0" <<endl;
-    num_clauses+=4;
-
+    logic_XOR2(outputs[k].first,outputs[k].second,mkLit(v),sink);
   }
 
   int OR_result = S.newVar();
   // clause of OR between all XOR's outputs
-  vec<Lit> clauseLiterals;
-  std::ostringstream  clause ;
+  vec<Lit> clauseLiterals, clause;
   clauseLiterals.push(~mkLit(OR_result));
-  clause << -(OR_result+1) << " ";
   
   std::vector<int>::const_iterator it;
   for(it=XOR_results.begin(); it!=XOR_results.end(); it++){
     int var = *it;
     clauseLiterals.push(mkLit(var));
-    clause << (var+1) << " ";
-    S.addClause(mkLit(OR_result),~mkLit(var));
-    file << (OR_result+1) <<" "<<-(var+1) <<" 0" <<endl;
-    num_clauses++;
-
+    clause.push(mkLit(OR_result));
+    clause.push(~mkLit(var));
+    sink.add(clause);
   }
-  S.addClause(clauseLiterals);
-  clause << "0";
-  file << clause.str() <<endl;
-  clauseLiterals.clear();
+  sink.add(clauseLiterals);
 
   // forcing OR result to be 1
-  S.addClause(mkLit(OR_result));
-  file << (OR_result+1) <<" 0" <<endl;
-  num_clauses+=2;
+  clause.push(mkLit(OR_result));
+  sink.fileOnly(clause);
 }
 
 
 /*
  in DFF we consider the inputs as outputs which need to be compared :
  we add pairs of the same input (by name of the port) to the output map.
+ (the DFF outputs are the same AIG input in both cells, see aigGraph::state)
 */
 void add_dffs_to_map(hcmInstance* spec_inst,hcmInstance* imp_inst,std::map< hcmNode*, hcmNode* > &outputs_cells){
   std::map<std::string, hcmInstPort* >::const_iterator ipI;
@@ -423,242 +484,40 @@ void add_dffs_to_map(hcmInstance* spec_inst,hcmInstance* imp_inst,std::map< hcmN
         }
       }
     } 
-    if(ip_spec->getPort()->getDirection()==OUT){
-      for (I =imp_inst_ports.begin(); I != imp_inst_ports.end(); I++){
-        hcmInstPort* ip_imp= I->second;
-        if(ip_imp->getPort()->getName()==ip_spec->getPort()->getName()){
-          hcmNode* node_imp= ip_imp->getNode();
-          int temp=0;
-          node_spec->getProp("variable_num",temp);
-          node_imp->setProp("variable_num",temp); // give imp dff output the same variable as in spec (it serves as "input")
-          // if the DFF connects directly to an output, we give both design the same output number, and not different number like in tutorial (as it doesn't affect the SAT decision in this specific case)
-        }
-      }
-    }
-  }
-}
-
-// add clauses for inverter and buffer (if inverted = true)
-void logic_Inverter(hcmInstance* inst,Solver &S,bool inverted,ofstream& file){
-  int input_var, output_var;
-  std::map<std::string, hcmInstPort* >::const_iterator ipI;
-  for (ipI =inst->getInstPorts().begin(); ipI != inst->getInstPorts().end(); ipI++){
-    hcmInstPort* ip= ipI->second;
-    hcmNode* node= ip->getNode();
-    if(ip->getPort()->getDirection()==OUT){
-      node->getProp("variable_num",output_var);
-    }
-    if(ip->getPort()->getDirection()==IN){
-      node->getProp("variable_num",input_var);
-    }
-  }
-  // cout << output_var <<endl;
-  // cout << input_var <<endl;
-  if(!inverted){
-    S.addClause(mkLit(output_var),mkLit(input_var));
-    S.addClause(~mkLit(output_var),~mkLit(input_var));
-    file << (output_var+1) <<" "<<(input_var+1) << " 0" <<endl;
-    file << -(output_var+1) <<" "<<-(input_var+1) << " 0" <<endl;    
-  }
-  else{
-    S.addClause(~mkLit(output_var),mkLit(input_var));
-    S.addClause(mkLit(output_var),~mkLit(input_var));
-    file << -(output_var+1) <<" "<<(input_var+1) << " 0" <<endl;
-    file << (output_var+1) <<" "<<-(input_var+1) << " 0" <<endl;  
-  }
-
-}
-
-// add clauses for AND and NAND gates (if inverted = true)
-void logic_AND(hcmInstance* inst,Solver &S, bool inverted,ofstream& file,int &num_clauses){
-  int output_var;
-  vector<int> input_var;
-  std::map<std::string, hcmInstPort* >::const_iterator ipI;
-  for (ipI =inst->getInstPorts().begin(); ipI != inst->getInstPorts().end(); ipI++){
-    hcmInstPort* ip= ipI->second;
-    hcmNode* node= ip->getNode();
-    if(ip->getPort()->getDirection()==OUT){
-      node->getProp("variable_num",output_var);
-    }
-    if(ip->getPort()->getDirection()==IN){
-      int input;
-      node->getProp("variable_num",input);
-      input_var.push_back(input);
-    }
-  }
-
-  std::ostringstream  clause ;
-
-  //Building Tseytin clauses
-  vec<Lit> clauseLiterals;
-  if(!inverted) {
-    clauseLiterals.push(mkLit(output_var));
-    clause << (output_var+1) << " ";
-  }
-  else {
-    clauseLiterals.push(~mkLit(output_var));
-    clause << -(output_var+1) << " ";
-  }
-  
-  std::vector<int>::const_iterator it;
-  for(it=input_var.begin(); it!=input_var.end(); it++){
-    int var = *it;
-    // cout << var <<endl;
-    clauseLiterals.push(~mkLit(var));
-    clause << -(var+1) << " ";
-    if(!inverted) {
-      S.addClause(~mkLit(output_var),mkLit(var));
-      file << -(output_var+1) <<" "<<(var+1) << " 0" <<endl;
-    }
-    else{ 
-      S.addClause(mkLit(output_var),mkLit(var));
-      file << (output_var+1) <<" "<<(var+1) << " 0" <<endl;
-    }
-    num_clauses++;
   }
-  S.addClause(clauseLiterals);
-  num_clauses++;
-  clause << "0";
-  file << clause.str() <<endl;
-
-  clauseLiterals.clear();
-}
-
-// add clauses for OR and NOR gates (if inverted = true)
-void logic_OR(hcmInstance* inst,Solver &S, bool inverted,ofstream& file,int &num_clauses){
-  int output_var;
-  vector<int> input_var;
-  std::map<std::string, hcmInstPort* >::const_iterator ipI;
-  for (ipI =inst->getInstPorts().begin(); ipI != inst->getInstPorts().end(); ipI++){
-    hcmInstPort* ip= ipI->second;
-    hcmNode* node= ip->getNode();
-    if(ip->getPort()->getDirection()==OUT){
-      node->getProp("variable_num",output_var);
-    }
-    if(ip->getPort()->getDirection()==IN){
-      int input;
-      node->getProp("variable_num",input);
-      input_var.push_back(input);
-
-    }
-  }
-  std::ostringstream  clause ;
-
-  //Building Tseytin clauses
-  vec<Lit> clauseLiterals;
-  if(!inverted) {
-    clauseLiterals.push(~mkLit(output_var));
-    clause << -(output_var+1) << " ";
-  }
-  else {
-    clauseLiterals.push(mkLit(output_var));
-    clause << (output_var+1) << " ";
-  }
-  
-  std::vector<int>::const_iterator it;
-  for(it=input_var.begin(); it!=input_var.end(); it++){
-    int var = *it;
-    // cout << var <<endl;
-    clauseLiterals.push(mkLit(var));
-    clause << (var+1) << " ";
-    if(!inverted) {
-      S.addClause(mkLit(output_var),~mkLit(var));
-      file << (output_var+1) <<" "<<-(var+1) << " 0" <<endl;
-    }
-    else {
-      S.addClause(~mkLit(output_var),~mkLit(var));
-      file << -(output_var+1) <<" "<<-(var+1) << " 0" <<endl;
-    }
-    num_clauses++;
-  }
-  S.addClause(clauseLiterals);
-  num_clauses++;
-  clause << "0";
-  file << clause.str() <<endl;
-  clauseLiterals.clear();
 }
 
-// add clauses for XOR and XNOR gates (if inverted = true)
-void logic_XOR(hcmInstance* inst,Solver &S, bool inverted,ofstream& file){
-  int output_var;
-  vector<int> input_var;
-  std::map<std::string, hcmInstPort* >::const_iterator ipI;
-  for (ipI =inst->getInstPorts().begin(); ipI != inst->getInstPorts().end(); ipI++){
-    hcmInstPort* ip= ipI->second;
-    hcmNode* node= ip->getNode();
-    if(ip->getPort()->getDirection()==OUT){
-      node->getProp("variable_num",output_var);
-    }
-    if(ip->getPort()->getDirection()==IN){
-      int input;
-      node->getProp("variable_num",input);
-      input_var.push_back(input);
-    }
-  }
-  //Building Tseytin clauses
-  if(!inverted){
-    S.addClause(~mkLit(input_var[0]),~mkLit(input_var[1]),~mkLit(output_var)); // (~A+ ~B+ ~C)
-    S.addClause(mkLit(input_var[0]),mkLit(input_var[1]),~mkLit(output_var)); // (A+ B+ ~C)
-    S.addClause(mkLit(input_var[0]),~mkLit(input_var[1]),mkLit(output_var)); // (A+ ~B+ C)
-    S.addClause(~mkLit(input_var[0]),mkLit(input_var[1]),mkLit(output_var)); // (~A+ B+ C)
-    file << -(input_var[0]+1) <<" "<<-(input_var[1]+1) << " " << -(output_var+1)<<" 0" <<endl;
-    file << (input_var[0]+1) <<" "<<(input_var[1]+1) << " " << -(output_var+1)<<" 0" <<endl;
-    file << (input_var[0]+1) <<" "<<-(input_var[1]+1) << " " << (output_var+1)<<" 0" <<endl;
-    file << -(input_var[0]+1) <<" "<<(input_var[1]+1) << " " << (output_var+1)<<" 0" <<endl;
-  }
-  else{
-    S.addClause(~mkLit(input_var[0]),~mkLit(input_var[1]),mkLit(output_var)); // (~A+ ~B+ C)
-    S.addClause(mkLit(input_var[0]),mkLit(input_var[1]),mkLit(output_var)); // (A+ B+ C)
-    S.addClause(mkLit(input_var[0]),~mkLit(input_var[1]),~mkLit(output_var)); // (A+ ~B+ ~C)
-    S.addClause(~mkLit(input_var[0]),mkLit(input_var[1]),~mkLit(output_var)); // (~A+ B+ ~C)
-    file << -(input_var[0]+1) <<" "<<-(input_var[1]+1) << " " << (output_var+1)<<" 0" <<endl;
-    file << (input_var[0]+1) <<" "<<(input_var[1]+1) << " " << (output_var+1)<<" 0" <<endl;
-    file << (input_var[0]+1) <<" "<<-(input_var[1]+1) << " " << -(output_var+1)<<" 0" <<endl;
-    file << -(input_var[0]+1) <<" "<<(input_var[1]+1) << " " << -(output_var+1)<<" 0" <<endl;
-  }
+// add clauses for out = a xor b
+void logic_XOR2(Lit a,Lit b,Lit c,clauseSink &sink){
+  vec<Lit> clause;
+  clause.push(~a); clause.push(~b); clause.push(~c); // (~A+ ~B+ ~C)
+  sink.add(clause);
+  clause.push(a); clause.push(b); clause.push(~c); // (A+ B+ ~C)
+  sink.add(clause);
+  clause.push(a); clause.push(~b); clause.push(c); // (A+ ~B+ C)
+  sink.add(clause);
+  clause.push(~a); clause.push(b); clause.push(c); // (~A+ B+ C)
+  sink.add(clause);
 }
 
-// add clauses for each instance type (supporting only stdcell instances)
-void Instance_Add_Clauses(hcmInstance* inst,Solver &S,ofstream& file,int &num_clauses){
-  string logic_name= inst->masterCell()->getName();
-  if(logic_name.find("nor")!=std::string::npos){
-    logic_OR(inst,S,true,file,num_clauses);
-    // cout<< "$nor" <<endl;
-  } else if(logic_name.find("xnor")!=std::string::npos){
-    logic_XOR(inst,S,true,file);
-    num_clauses+=4;//supported only xor 2
-    // cout<< "$xnor" <<endl;
-  } else if(logic_name.find("xor")!=std::string::npos){
-    logic_XOR(inst,S,false,file);
-    num_clauses+=4;//supported only xor 2
-    // cout<< "$xor" <<endl;
-  } else if(logic_name.find("or")!=std::string::npos){
-    logic_OR(inst,S,false,file,num_clauses);
-    // cout<< "$or" <<endl;
-  } else if(logic_name.find("nand")!=std::string::npos){
-    logic_AND(inst,S,true,file,num_clauses);
-    // cout<< "$nand" <<endl;
-  } else if(logic_name.find("and")!=std::string::npos){
-    logic_AND(inst,S,false,file,num_clauses);
-    // cout<< "$and" <<endl;
-  } else if(logic_name.find("buffer")!=std::string::npos){
-    logic_Inverter(inst,S,true,file); //buffer is an inverted inverter :)
-    num_clauses+=2;
-    // cout<< "$buffer" <<endl;
-  } else if(logic_name.find("inv")!=std::string::npos){
-    logic_Inverter(inst,S,false,file);
-    num_clauses+=2;
-    // cout<< "$inv" <<endl;
-  } else if(logic_name.find("not")!=std::string::npos){
-    logic_Inverter(inst,S,false,file);
-    num_clauses+=2;
-    // cout<< "$inv" <<endl;
-  } else if(logic_name.find("dff")!=std::string::npos){
-    // remember DFF inputs (used as "outputs") are needed to be compared between the cells 
-    // however no logic functioning for dff so we do nothing here
-  } else{
-    cerr << "-E- does not support gate type: " << logic_name << " aborting." << endl;
-    exit(1);
+/*
+  add the tseytin clauses of every AND node of the AIG in the cone:
+  n = a & b  is  (~n + a) (~n + b) (n + ~a + ~b)
+*/
+void AIG_Add_Clauses(aigGraph &aig,vector<int> &aig_var,vector<int> &cone,clauseSink &sink){
+  vec<Lit> clause;
+  for(size_t k=0; k<cone.size(); k++){
+    int node = cone[k];
+    if(!aig.isAnd(node)) continue;
+    Lit n = mkLit(aig_var[node]);
+    Lit a = aig_lit(aig.fanin0[node],aig_var);
+    Lit b = aig_lit(aig.fanin1[node],aig_var);
+    clause.push(~n); clause.push(a);
+    sink.add(clause);
+    clause.push(~n); clause.push(b);
+    sink.add(clause);
+    clause.push(n); clause.push(~a); clause.push(~b);
+    sink.add(clause);
   }
 }
 
@@ -671,7 +530,7 @@ void Instance_Add_Clauses(hcmInstance* inst,Solver &S,ofstream& file,int &num_cl
   It also update the dff map and output map.
 */
 
-bool compatible_cells(hcmCell *flatCell_spec,hcmCell *flatCell_imp, 
+bool compatible_cells(cellLibrary &lib,hcmCell *flatCell_spec,hcmCell *flatCell_imp, 
   std::map< hcmNode*, hcmNode* > &outputs_cells,std::map< hcmInstance*, hcmInstance* > &dff_cells){
   //check if every output name match between the 2 cells
   int out_ports_spec =0 ,out_ports_imp=0 ;
@@ -711,8 +570,11 @@ bool compatible_cells(hcmCell *flatCell_spec,hcmCell *flatCell_imp,
   std::map< std::string, hcmInstance* > instances_imp = flatCell_imp->getInstances();
   for(iI =instances_spec.begin(); iI != instances_spec.end(); iI++){
     hcmInstance* inst_spec= iI->second;
-    string logic_name= inst_spec->masterCell()->getName();
-    if(logic_name.find("dff")!=std::string::npos){
+    const cellDesc *desc = lib.lookup(inst_spec->masterCell());
+    if(!desc){
+      exit(1);
+    }
+    if(desc->type==CELL_DFF){
       DFF_spec++;
       string inst_name= inst_spec->getName();
       hcmInstance *inst_imp = flatCell_imp->getInst(inst_name);
@@ -727,8 +589,11 @@ bool compatible_cells(hcmCell *flatCell_spec,hcmCell *flatCell_imp,
   // check if both cells have the same amount of DFF
   for(iI =instances_imp.begin(); iI != instances_imp.end(); iI++){
     hcmInstance* inst_imp= iI->second;
-    string logic_name= inst_imp->masterCell()->getName();
-    if(logic_name.find("dff")!=std::string::npos){
+    const cellDesc *desc = lib.lookup(inst_imp->masterCell());
+    if(!desc){
+      exit(1);
+    }
+    if(desc->type==CELL_DFF){
       DFF_imp++;
     }
   }
@@ -0,0 +1,33 @@
+// the reference rebuilt: xor per bit, a nor/nand tree in another order, a parity tree
+module and2(A,B,Y); input A,B; output Y; endmodule
+module nand2(A,B,Y); input A,B; output Y; endmodule
+module nor2(A,B,Y); input A,B; output Y; endmodule
+module xor2(A,B,Y); input A,B; output Y; endmodule
+module xnor2(A,B,Y); input A,B; output Y; endmodule
+module inv(A,Y); input A; output Y; endmodule
+module buffer(A,Y); input A; output Y; endmodule
+module dff(D,CLK,Q); input D,CLK; output Q; endmodule
+
+module cmp(A0,A1,A2,A3,B0,B1,B2,B3,C,CLK,EQ,P,O);
+ input A0,A1,A2,A3,B0,B1,B2,B3,C,CLK; output EQ,P,O;
+ wire n0,n1,n2,n3,o03,o12,m,eq,h0,h1,r0,d,nd,q,nq,nc;
+ xor2 x0(.A(B0),.B(A0),.Y(n0));
+ xor2 x1(.A(B1),.B(A1),.Y(n1));
+ xor2 x2(.A(B2),.B(A2),.Y(n2));
+ xor2 x3(.A(B3),.B(A3),.Y(n3));
+ nor2 t0(.A(n0),.B(n3),.Y(o03));
+ nor2 t1(.A(n1),.B(n2),.Y(o12));
+ nand2 t2(.A(o12),.B(o03),.Y(m));
+ inv t3(.A(m),.Y(eq));
+ xor2 p0(.A(A0),.B(A2),.Y(h0));
+ xor2 p1(.A(A3),.B(A1),.Y(h1));
+ xnor2 p2(.A(h0),.B(h1),.Y(r0));
+ inv p3(.A(r0),.Y(P));
+ xnor2 f0(.A(C),.B(eq),.Y(nd));
+ inv f1(.A(nd),.Y(d));
+ dff r1(.D(d),.CLK(CLK),.Q(q));
+ inv f2(.A(q),.Y(nq));
+ inv f3(.A(C),.Y(nc));
+ nor2 f4(.A(nq),.B(nc),.Y(O));
+ buffer b0(.A(eq),.Y(EQ));
+endmodule
@@ -0,0 +1,28 @@
+// reference: 4 bit equality, parity of A and a registered flag
+module and2(A,B,Y); input A,B; output Y; endmodule
+module nand2(A,B,Y); input A,B; output Y; endmodule
+module nor2(A,B,Y); input A,B; output Y; endmodule
+module xor2(A,B,Y); input A,B; output Y; endmodule
+module xnor2(A,B,Y); input A,B; output Y; endmodule
+module inv(A,Y); input A; output Y; endmodule
+module buffer(A,Y); input A; output Y; endmodule
+module dff(D,CLK,Q); input D,CLK; output Q; endmodule
+
+module cmp(A0,A1,A2,A3,B0,B1,B2,B3,C,CLK,EQ,P,O);
+ input A0,A1,A2,A3,B0,B1,B2,B3,C,CLK; output EQ,P,O;
+ wire e0,e1,e2,e3,a01,a23,eq,p1,p2,d,q;
+ xnor2 x0(.A(A0),.B(B0),.Y(e0));
+ xnor2 x1(.A(A1),.B(B1),.Y(e1));
+ xnor2 x2(.A(A2),.B(B2),.Y(e2));
+ xnor2 x3(.A(A3),.B(B3),.Y(e3));
+ and2 t0(.A(e0),.B(e1),.Y(a01));
+ and2 t1(.A(e2),.B(e3),.Y(a23));
+ and2 t2(.A(a01),.B(a23),.Y(eq));
+ xor2 p0(.A(A0),.B(A1),.Y(p1));
+ xor2 p1(.A(p1),.B(A2),.Y(p2));
+ xor2 p2(.A(p2),.B(A3),.Y(P));
+ xor2 f0(.A(eq),.B(C),.Y(d));
+ dff r1(.D(d),.CLK(CLK),.Q(q));
+ and2 f1(.A(q),.B(C),.Y(O));
+ buffer b0(.A(eq),.Y(EQ));
+endmodule
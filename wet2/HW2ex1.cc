@@ -4,13 +4,26 @@
 #include <fstream>
 #include "hcm.h"
 #include "flat.h"
-#include "hcmvcd.h"
 #include <iostream>
 #include <set>
 #include <string>
 #include <stdlib.h>
-#include "hcmsigvec.h"
-#include <queue>
+#include <chrono>
+#include "stimReader.h"
+#include "faultSim.h"
+#include "timedSim.h"
+#include "fourState.h"
+#include "checkpoint.h"
+#include "activity.h"
+#include "batchSim.h"
+#include "monitor.h"
+#include "simIR.h"
+#include "simSched.h"
+#include "bitSim.h"
+#include "codeGen.h"
+#include "parSim.h"
+#include "vcdWriter.h"
+#include "glwWriter.h"
 
 
 using namespace std;
@@ -19,24 +32,25 @@ bool verbose = false;
 
 ///////////////////////////////////////////////////////////////////////////
 
-// Event Class, used to contain Node pointer and its value
-class Event{
-  public:
-    hcmNode *Node;
-    bool val;
-    Event(hcmNode *N,bool value){
-      Node=N;
-      val=value;
-    }
-
-} ;
+// simulation engines selectable with -engine
+enum simEngine { ENGINE_EVENT, ENGINE_CYCLE, ENGINE_CHECK, ENGINE_COMPILED, ENGINE_PARALLEL, ENGINE_TIMED };
 
 /* functions declarations */
-bool IsGlobalNode(hcmNode *Node,set< string> &globalNodes);
-void Simulate_Gate(hcmInstance * inst,std::queue< Event > &EventQueue);
-void Gate_Processor(std::queue< Event > &EventQueue,std::queue<hcmInstance *> &GateQueue);
-bool Gate_Exist(std::queue<hcmInstance *> GateQueue,string inst_name);
-void Event_Processor(std::queue< Event > &EventQueue,std::queue<hcmInstance *> &GateQueue);
+void Simulate_Gate(const simIR &ir,simState &st,int inst,simScheduler &sched);
+void Gate_Processor(const simIR &ir,simState &st,simScheduler &sched);
+void Event_Processor(const simIR &ir,simState &st,simScheduler &sched);
+void Event_Simulate(const simIR &ir,simState &st,simScheduler &sched,
+  vector<int> &sigNodes,vector<char> &sigVals,bool first);
+void Cycle_Simulate(const simIR &ir,simState &st,vector<int> &sigNodes,vector<char> &sigVals);
+int Compare_States(const simIR &ir,simState &st,simState &ref,unsigned int time);
+bool logic_OR(const simIR &ir,simState &st,int inst);
+bool logic_XOR(const simIR &ir,simState &st,int inst);
+bool logic_AND(const simIR &ir,simState &st,int inst);
+bool logic_BUFFER(const simIR &ir,simState &st,int inst);
+bool DFF_Edge(const simIR &ir,simState &st,int inst);
+void Clock_Domain_Edge(const simIR &ir,simState &st,int domain,simScheduler &sched);
+bool Clock_Edges(const simIR &ir,simState &st,simScheduler &sched);
+void Sample_Domains(const simIR &ir,simState &st);
 // implementation in the end 
 
 int main(int argc, char **argv) {
@@ -46,28 +60,214 @@ int main(int argc, char **argv) {
   vector<string> vlgFiles;
   string sigsFileName;
   string vecsFileName;
-
-  if (argc < 5) {
-    anyErr++;
-  } else {
+  int lanes = 1;     // 64/256/512 selects the bit-parallel mode
+  int dumpLane = 0;  // lane written to the vcd in bit-parallel mode
+  simEngine engine = ENGINE_EVENT;
+  string cacheDir = "gl_sim_cache"; // compiled netlists of -engine compiled
+  int threads = std::thread::hardware_concurrency(); // threads of -engine parallel
+  bool bench = false;                // report parallel speedup versus threads instead of simulating
+  bool glw = false;                  // binary waveform (cell.glw) instead of cell.vcd
+  bool noWave = false;               // -wave none: no waveform file (benchmarking)
+  bool hcmStim = true;               // read the vectors through hcmSigVec, -stim fast: the mapped reader
+  bool stimGiven = false;            // -stim was given
+  string packFile;                   // -pack: write the vectors as a packed glv file and exit
+  bool faults = false;               // stuck-at fault simulation instead of a waveform
+  string delayFile;                  // rise/fall delays of -engine timed
+  unsigned long long period = 0;     // time between vectors of -engine timed, 0 = critical path + 1
+  bool fourState = false;            // 0/1/X/Z values in the event driven engine
+  unsigned long ckptEvery = 0;       // -checkpoint: write cell_<time>.ckpt every n vectors
+  string resumeFile;                 // -resume: start from a checkpoint
+  bool activity = false;             // toggle counts of the event processor written to cell.saif
+  string capFile;                    // -caps: capacitance weights of the activity report
+  string batchFile;                  // -batch: manifest of testbenches, replaces sigFile vecFile
+  unsigned long long randomVectors = 0; // -random: in-process pseudo random vectors, replaces vecFile
+  unsigned long long seed = 1;       // seed of -random
+  double toggleProb = 0.5;           // probability an input changes in a -random vector
+  string clockPattern = "01";        // clock values of the -random vectors, repeated
+  vector<string> clockNames;         // -clocks: the clock signals of -random, default the inputs driving dff clocks
+  string monitorFile;                // -monitors: properties checked after every vector
+  bool stopOnFail = false;           // -stoponfail: end the run at the first monitor failure
+  string observeFile;                // -observe: simulate only the fan-in cone of the listed nodes
+
+  // options come before the top-cell
+  while (argIdx < argc && argv[argIdx][0] == '-') {
     if (!strcmp(argv[argIdx], "-v")) {
-      argIdx++;
       verbose = true;
+    } else if (!strcmp(argv[argIdx], "-lanes") && argIdx+1 < argc) {
+      lanes = atoi(argv[++argIdx]);
+      if (lanes != 64 && lanes != 256 && lanes != 512) {
+        cerr << "-E- -lanes must be 64, 256 or 512" << endl;
+        anyErr++;
+      }
+    } else if (!strcmp(argv[argIdx], "-dumplane") && argIdx+1 < argc) {
+      dumpLane = atoi(argv[++argIdx]);
+    } else if (!strcmp(argv[argIdx], "-engine") && argIdx+1 < argc) {
+      argIdx++;
+      if (!strcmp(argv[argIdx], "event")) {
+        engine = ENGINE_EVENT;
+      } else if (!strcmp(argv[argIdx], "cycle")) {
+        engine = ENGINE_CYCLE;
+      } else if (!strcmp(argv[argIdx], "check")) {
+        engine = ENGINE_CHECK;
+      } else if (!strcmp(argv[argIdx], "compiled")) {
+        engine = ENGINE_COMPILED;
+      } else if (!strcmp(argv[argIdx], "parallel")) {
+        engine = ENGINE_PARALLEL;
+      } else if (!strcmp(argv[argIdx], "timed")) {
+        engine = ENGINE_TIMED;
+      } else {
+        cerr << "-E- -engine must be event, cycle, check, compiled, parallel or timed" << endl;
+        anyErr++;
+      }
+    } else if (!strcmp(argv[argIdx], "-cache") && argIdx+1 < argc) {
+      cacheDir = argv[++argIdx];
+    } else if (!strcmp(argv[argIdx], "-threads") && argIdx+1 < argc) {
+      threads = atoi(argv[++argIdx]);
+      if (threads < 1) {
+        cerr << "-E- -threads must be at least 1" << endl;
+        anyErr++;
+      }
+    } else if (!strcmp(argv[argIdx], "-wave") && argIdx+1 < argc) {
+      argIdx++;
+      if (!strcmp(argv[argIdx], "vcd")) {
+        glw = false;
+      } else if (!strcmp(argv[argIdx], "glw")) {
+        glw = true;
+      } else if (!strcmp(argv[argIdx], "none")) {
+        noWave = true;
+      } else {
+        cerr << "-E- -wave must be vcd, glw or none" << endl;
+        anyErr++;
+      }
+    } else if (!strcmp(argv[argIdx], "-stim") && argIdx+1 < argc) {
+      argIdx++;
+      stimGiven = true;
+      if (!strcmp(argv[argIdx], "fast")) {
+        hcmStim = false;
+      } else if (!strcmp(argv[argIdx], "hcm")) {
+        hcmStim = true;
+      } else {
+        cerr << "-E- -stim must be hcm or fast" << endl;
+        anyErr++;
+      }
+    } else if (!strcmp(argv[argIdx], "-pack") && argIdx+1 < argc) {
+      packFile = argv[++argIdx];
+    } else if (!strcmp(argv[argIdx], "-delays") && argIdx+1 < argc) {
+      delayFile = argv[++argIdx];
+    } else if (!strcmp(argv[argIdx], "-period") && argIdx+1 < argc) {
+      period = strtoull(argv[++argIdx], NULL, 10);
+    } else if (!strcmp(argv[argIdx], "-faults")) {
+      faults = true;
+    } else if (!strcmp(argv[argIdx], "-4state")) {
+      fourState = true;
+    } else if (!strcmp(argv[argIdx], "-checkpoint") && argIdx+1 < argc) {
+      ckptEvery = strtoul(argv[++argIdx], NULL, 10);
+    } else if (!strcmp(argv[argIdx], "-resume") && argIdx+1 < argc) {
+      resumeFile = argv[++argIdx];
+    } else if (!strcmp(argv[argIdx], "-batch") && argIdx+1 < argc) {
+      batchFile = argv[++argIdx];
+    } else if (!strcmp(argv[argIdx], "-random") && argIdx+1 < argc) {
+      randomVectors = strtoull(argv[++argIdx], NULL, 10);
+      if (randomVectors == 0) {
+        cerr << "-E- -random needs a number of vectors" << endl;
+        anyErr++;
+      }
+    } else if (!strcmp(argv[argIdx], "-seed") && argIdx+1 < argc) {
+      seed = strtoull(argv[++argIdx], NULL, 10);
+    } else if (!strcmp(argv[argIdx], "-toggle") && argIdx+1 < argc) {
+      toggleProb = atof(argv[++argIdx]);
+      if (toggleProb < 0 || toggleProb > 1) {
+        cerr << "-E- -toggle must be a probability between 0 and 1" << endl;
+        anyErr++;
+      }
+    } else if (!strcmp(argv[argIdx], "-clock") && argIdx+1 < argc) {
+      clockPattern = argv[++argIdx];
+    } else if (!strcmp(argv[argIdx], "-clocks") && argIdx+1 < argc) {
+      // comma separated signal names
+      stringstream names(argv[++argIdx]);
+      string name;
+      while (getline(names, name, ',')) {
+        if (!name.empty()) clockNames.push_back(name);
+      }
+    } else if (!strcmp(argv[argIdx], "-monitors") && argIdx+1 < argc) {
+      monitorFile = argv[++argIdx];
+    } else if (!strcmp(argv[argIdx], "-observe") && argIdx+1 < argc) {
+      observeFile = argv[++argIdx];
+    } else if (!strcmp(argv[argIdx], "-stoponfail")) {
+      stopOnFail = true;
+    } else if (!strcmp(argv[argIdx], "-activity")) {
+      activity = true;
+    } else if (!strcmp(argv[argIdx], "-caps") && argIdx+1 < argc) {
+      capFile = argv[++argIdx];
+      activity = true;
+    } else if (!strcmp(argv[argIdx], "-bench")) {
+      bench = true;
+      engine = ENGINE_PARALLEL;
+    } else {
+      cerr << "-E- unknown option " << argv[argIdx] << endl;
+      anyErr++;
     }
-    for (int i=argIdx;i < argc; i++) {
-      vlgFiles.push_back(string(argv[i]));
+    argIdx++;
+  }
+  for (int i=argIdx;i < argc; i++) {
+    vlgFiles.push_back(string(argv[i]));
+  }
+  // with -batch the signals and vectors files come from the manifest
+  // and -random replaces the vectors file
+  unsigned int firstVlg = !batchFile.empty() ? 1 : randomVectors ? 2 : 3;
+  if (!batchFile.empty()) {
+    if (vlgFiles.size() < 2) {
+      cerr << "-E- At least top-level and single verilog file required with -batch" << endl;
+      anyErr++;
     }
-    sigsFileName = string(argv[1+argIdx++]);
-    vecsFileName = string(argv[1+argIdx++]);
-    
-    if (vlgFiles.size() < 4) {
-      cerr << "-E- At least top-level, signals-file, vectors-file and single verilog file required for spec model" << endl;
+  } else if (randomVectors) {
+    if (vlgFiles.size() < 3) {
+      cerr << "-E- At least top-level, signals-file and single verilog file required with -random" << endl;
       anyErr++;
+    } else {
+      sigsFileName = vlgFiles[1];
     }
+  } else if (vlgFiles.size() < 4) {
+    cerr << "-E- At least top-level, signals-file, vectors-file and single verilog file required for spec model" << endl;
+    anyErr++;
+  } else {
+    sigsFileName = vlgFiles[1];
+    vecsFileName = vlgFiles[2];
+  }
+  if (dumpLane < 0 || dumpLane >= (lanes > 1 ? lanes : 1)) {
+    cerr << "-E- -dumplane must be a lane number below -lanes" << endl;
+    anyErr++;
+  }
+  if (fourState && (engine != ENGINE_EVENT || lanes > 1 || faults)) {
+    cerr << "-E- -4state is supported by the event engine only" << endl;
+    anyErr++;
+  }
+  if ((ckptEvery || !resumeFile.empty()) && (engine == ENGINE_TIMED || lanes > 1 || faults || bench)) {
+    cerr << "-E- -checkpoint and -resume are not supported with -engine timed, -lanes, -faults or -bench" << endl;
+    anyErr++;
+  }
+  if (activity && ((engine != ENGINE_EVENT && engine != ENGINE_TIMED) || lanes > 1 || faults)) {
+    cerr << "-E- -activity counts the events of -engine event or timed" << endl;
+    anyErr++;
+  }
+  if (!batchFile.empty() && ((engine != ENGINE_EVENT && engine != ENGINE_CYCLE) || lanes > 1 || faults ||
+                             !packFile.empty() || ckptEvery || !resumeFile.empty() || activity)) {
+    cerr << "-E- -batch runs the event or cycle engine only" << endl;
+    anyErr++;
+  }
+  if (!monitorFile.empty() && (lanes > 1 || faults || bench || !batchFile.empty())) {
+    cerr << "-E- -monitors is not supported with -lanes, -faults, -bench or -batch" << endl;
+    anyErr++;
+  }
+  if (randomVectors && (stimGiven || !batchFile.empty())) {
+    cerr << "-E- -random can not be used with -stim or -batch" << endl;
+    anyErr++;
   }
 
   if (anyErr) {
-    cerr << "Usage: " << argv[0] << "  [-v] top-cell sigFile vecFile file1.v [file2.v] ... \n";
+    cerr << "Usage: " << argv[0] << "  [-v] [-engine event|cycle|check|compiled|parallel|timed] [-delays file] [-period n] [-cache dir] [-threads n [-bench]] [-wave vcd|glw|none] [-stim hcm|fast] [-pack out.glv] [-faults] [-4state] [-checkpoint n] [-resume file.ckpt] [-activity [-caps file]] [-monitors file [-stoponfail]] [-observe file] [-lanes 64|256|512 [-dumplane k]] top-cell sigFile vecFile file1.v [file2.v] ... \n"
+         << "       " << argv[0] << "  [options] -random n [-seed s] [-toggle p] [-clock 01] [-clocks name,..] top-cell sigFile file1.v [file2.v] ... \n"
+         << "       " << argv[0] << "  [options] [-threads n] -batch manifest top-cell file1.v [file2.v] ... \n";
     exit(1);
   }
  
@@ -77,7 +277,7 @@ int main(int argc, char **argv) {
 
   hcmDesign* design = new hcmDesign("design");
   string cellName = vlgFiles[0];
-  for (i = 3; i < vlgFiles.size(); i++) {
+  for (i = firstVlg; i < vlgFiles.size(); i++) {
     printf("-I- Parsing verilog %s ...\n", vlgFiles[i].c_str());
     if (!design->parseStructuralVerilog(vlgFiles[i].c_str())) {
       cerr << "-E- Could not parse: " << vlgFiles[i] << " aborting." << endl;
@@ -94,346 +294,539 @@ int main(int argc, char **argv) {
   hcmCell *flatCell = hcmFlatten(cellName + string("_flat"), topCell, globalNodes);
   cout << "-I- Top cell flattened" << endl;
 
-  hcmSigVec parser(sigsFileName, vecsFileName, verbose);
-  if(!parser.good()){
+  // One time compile of the flat cell: dense node/instance ids, CSR fanin/fanout,
+  // cell descriptors from the cell library and the packed value array (all nodes false, VDD true).
+  cellLibrary lib;
+  simIR ir;
+  if(!buildSimIR(flatCell, globalNodes, lib, ir)){
+    exit(1);
+  }
+  // -observe: the sub-netlist driving the observed nodes replaces the flat cell,
+  // only it is simulated and dumped
+  if (!observeFile.empty()) {
+    simIR cone;
+    if (!sliceSimIR(ir, observeFile, cone)) {
+      exit(1);
+    }
+    cout << "-I- Observed cone: " << cone.numInsts << " of " << ir.numInsts << " instances, "
+         << cone.numNodes << " of " << ir.numNodes << " nodes" << endl;
+    ir = std::move(cone);
+  }
+  // monitors compiled against the node ids
+  monitorSet monitors;
+  monitors.stopOnFail = stopOnFail;
+  if (!monitorFile.empty() && !monitors.load(monitorFile, ir)) {
     exit(1);
   }
-  set<string> sigs;
-  parser.getSignals(sigs);
-  for (set<string>::iterator I= sigs.begin(); I != sigs.end(); I++) {
-    cout << "SIG: " << (*I) << endl;
-  }
-
-  // For any nodes set property: first_run initialized as true. so that even if output 
-  // doesn't change in the first run, we add it to the EventQueue anyway.
-  // set propety for Nodes : cur_val,prev_val Initalized with false.
-  // if it is a Global Node of type VDD cur_val=true.
-  std::map< std::string, hcmNode* >::const_iterator nI;
-  for (nI =flatCell->getNodes().begin(); nI != flatCell->getNodes().end(); nI++){
-    hcmNode *node= nI->second;
-    node->setProp("cur_val",false);
-    // node->setProp("prev_val",false);  
-    node->setProp("first_run",true);    
-    if(node->getName()=="VDD"){
-      node->setProp("cur_val",true); 
-      // node->setProp("prev_val",true); 
-    }
-    if(node->getName()=="CLK"){ 
-      node->setProp("prev_CLK",false); 
-    }
-  } 
-
-  // set property for dff instance: prev_val = false. it stores the data from the previous cycle.
-  map<string,hcmInstance*>::const_iterator iI;
-  for (iI=flatCell->getInstances().begin(); iI!=flatCell->getInstances().end();iI++) {
-      string instname = iI->first; 
-      hcmInstance* inst = iI->second;   
-      if (string::npos != instname.find("dff")) {
-        inst->setProp("prev_val", false);   
+
+  if (!batchFile.empty()) {
+    // testbenches of the manifest on a thread pool, each with its own state over the shared ir
+    vector<batchJob> jobs;
+    if (!readManifest(batchFile, jobs) || (engine == ENGINE_CYCLE && !levelizeSimIR(ir))) {
+      exit(1);
+    }
+    auto testbench = [&](stimReader &tb, waveWriter &out) -> unsigned long {
+      simState s;
+      s.init(ir);
+      fourStateSim f(ir);
+      if (fourState) {
+        f.init(s, tb.nodes);
       }
+      simScheduler sc;
+      sc.init(ir.numNodes, ir.numInsts);
+      vector<char> vals(tb.nodes.size(), 0);
+      unsigned long t = 0;
+      while (tb.next(vals)) {
+        if (engine == ENGINE_CYCLE) {
+          Cycle_Simulate(ir,s,tb.nodes,vals);
+        } else if (fourState) {
+          f.simulate(s,tb.nodes,vals,t==0);
+        } else {
+          Event_Simulate(ir,s,sc,tb.nodes,vals,t==0);
+        }
+        out.changeTime(t);
+        out.dumpChanges(s, engine == ENGINE_EVENT);
+        t++;
+      }
+      return t;
+    };
+    return runBatch(ir, jobs, threads, hcmStim, glw, flatCell->getName(), testbench) ? 1 : 0;
   }
-  // Event queue containing Events Class (hcmNode *Node,bool new_value)
-  std::queue< Event > EventQueue;
-  // Gate queue containing instances (hcmInstance *)
-  std::queue< hcmInstance * > GateQueue;
 
+  // stimulus: signal names bound to node ids once, vectors file mapped
+  stimReader stim;
+  if(randomVectors ? !stim.openRandom(sigsFileName, ir, randomVectors, seed, toggleProb, clockPattern, clockNames)
+                    : !stim.open(sigsFileName, vecsFileName, ir, hcmStim, verbose)){
+    exit(1);
+  }
+  for (i = 0; i < stim.names.size(); i++) {
+    cout << "SIG: " << stim.names[i] << endl;
+  }
+  vector<int> &sigNodes = stim.nodes;
+  if (!packFile.empty()) {
+    long rows = packVectors(stim, packFile);
+    if (rows < 0) {
+      exit(1);
+    }
+    cout << "-I- Packed " << rows << " vectors into " << packFile << endl;
+    return(0);
+  }
 
-  // vcd file initalization
-  vcdFormatter vcd(cellName + ".vcd", flatCell, globalNodes);
-  if (!vcd.good()) {
-    printf("-E- Could not create vcdFormatter for cell: %s\n", cellName.c_str());
+  // simulation state (values, clock history, dff data) over the read-only ir
+  simState st;
+  st.init(ir);
+  // -4state: every node starts X, undriven nodes Z
+  fourStateSim fsim(ir);
+  if (fourState) {
+    fsim.init(st, sigNodes);
+  }
+  // -activity: per node toggle counters, cell loads from the capacitance weights
+  // (-random counts them too, for its events/sec report)
+  vector<double> capLoad;
+  if (activity || (randomVectors && (engine == ENGINE_EVENT || engine == ENGINE_TIMED))) {
+    st.toggles.assign(ir.numNodes, 0);
+  }
+  if (activity) {
+    if (!capFile.empty() && !loadCapWeights(capFile, ir, capLoad)) {
+      exit(1);
+    }
+  }
+  // second state for -engine check, simulated by the cycle engine
+  simState chk;
+  if (engine != ENGINE_EVENT || faults) {
+    if (!levelizeSimIR(ir)) {
+      exit(1);
+    }
+    chk.init(ir);
+  }
+  if (faults) {
+    // fault coverage of the vectors file, one report line per fault in cell.faults
+    return runFaultSim(ir, stim, threads, cellName + ".faults") ? 0 : 1;
+  }
+  // netlist compiled to C++ and loaded as a shared object
+  compiledSim csim;
+  if (engine == ENGINE_COMPILED && !csim.load(ir, cacheDir)) {
     exit(1);
   }
+
+  // delta scheduler: pending node events and the gates to evaluate
+  simScheduler sched;
+  sched.init(ir.numNodes, ir.numInsts);
+
+
+  // vcd (or glw) file initalization, the glw writer completes the file when deleted
+  // per-cell delays on a timing wheel
+  timedSim *tsim = NULL;
+  string timescale = "1ns";
+  if (engine == ENGINE_TIMED) {
+    tsim = new timedSim(ir);
+    if (!delayFile.empty() && !tsim->loadDelays(delayFile)) {
+      exit(1);
+    }
+    if (period == 0) {
+      period = tsim->criticalPath() + 1;
+    }
+    timescale = tsim->timescale;
+    cout << "-I- Timed simulation, vector period " << period << " x " << timescale << endl;
+  }
+
+  waveWriter *wave;
+  if (noWave) {
+    wave = new nullWriter(ir);
+  } else if (glw) {
+    wave = new glwWriter(cellName + ".glw", ir, flatCell->getName(), timescale);
+  } else {
+    wave = new vcdWriter(cellName + ".vcd", ir, flatCell->getName(), timescale);
+  }
+  if (!wave->good()) {
+    printf("-E- Could not create %s file for cell: %s\n", glw ? "glw" : "vcd", cellName.c_str());
+    exit(1);
+  }
+  waveWriter &vcd = *wave;
+  if (lanes > 1) {
+    // bit-parallel pattern simulation of lane segments, dumping one lane
+    bool ok = runBitParallel(ir, stim, lanes, dumpLane, vcd);
+    delete wave;
+    return ok ? 0 : 1;
+  }
+  if (bench) {
+    // all vectors in memory (one char per signal) so only the simulation is timed
+    vector<char> rows, vals;
+    while (stim.next(vals)) {
+      rows.insert(rows.end(), vals.begin(), vals.end());
+    }
+    benchParallel(ir, sigNodes, rows, threads);
+    delete wave;
+    return(0);
+  }
+  // levelized simulation on a thread pool
+  parallelSim *psim = NULL;
+  if (engine == ENGINE_PARALLEL) {
+    psim = new parallelSim(ir, threads);
+    cout << "-I- Parallel simulation on " << psim->numThreads() << " threads, "
+         << psim->cutNets() << " cut nets" << endl;
+  }
+
   //controlling simulation time
   unsigned int time = 0;
-  //no instance parents of in the flat model.
-  list<const hcmInstance*> noInsts;
+  int mismatches = 0;
+  // values of the signals of the current vector (same order as sigNodes)
+  vector<char> sigVals(sigNodes.size(), 0);
+  // -resume: node values, dff data, clock history and vector file position of a checkpoint
+  if (!resumeFile.empty()) {
+    ckptPosition at;
+    if (!readCheckpoint(resumeFile, ir, st, at) || !stim.seek(at.offset, at.line)) {
+      exit(1);
+    }
+    if (engine == ENGINE_CHECK) {
+      chk.val = st.val;
+      chk.prevVal = st.prevVal;
+      chk.dffState = st.dffState;
+    }
+    time = at.time;
+    cout << "-I- Resumed from " << resumeFile << " at vector " << time << endl;
+  }
 
   // read the vectors file one line at a time until the eof
   // cout << "-I- Reading vectors ... " << endl;
-  while (parser.readVector() == 0) {
-    vcd.changeTime(time);
+  chrono::steady_clock::time_point simStart = chrono::steady_clock::now();
+  while (stim.next(sigVals)) {
     // cout << "$Time = " << time <<endl;
-    for (set<string>::iterator I= sigs.begin(); I != sigs.end(); I++) {
-      string name = (*I);
-      bool val;
-      parser.getSigValue(name, val);
-      hcmNode *node=flatCell->getNode(name);
-      Event new_event(node,val);
-      EventQueue.push(new_event);
-      if(node->getName()=="CLK"){
-        bool prev_clk;
-        node->getProp("cur_val",prev_clk); 
-        node->setProp("prev_CLK",prev_clk); 
-      }
-      // cout << "  " << name << " = " << (val? "1" : "0")  << endl;
+    if (engine == ENGINE_CYCLE) {
+      Cycle_Simulate(ir,st,sigNodes,sigVals);
+    } else if (engine == ENGINE_COMPILED) {
+      csim.simulate(ir,st,sigNodes,sigVals);
+    } else if (engine == ENGINE_PARALLEL) {
+      psim->simulate(st,sigNodes,sigVals);
+    } else if (engine == ENGINE_TIMED) {
+      // writes its own waveform, at the times of the events
+      tsim->simulate(st,sigNodes,sigVals,(unsigned long long)time*period,period,vcd);
+    } else if (fourState) {
+      fsim.simulate(st,sigNodes,sigVals,time==0);
+    } else {
+      Event_Simulate(ir,st,sched,sigNodes,sigVals,time==0);
     }
-    while(!EventQueue.empty()){
-      Event_Processor(EventQueue,GateQueue);
-      if(!GateQueue.empty()){
-        Gate_Processor(EventQueue,GateQueue);
-      }
+    if (engine == ENGINE_CHECK) {
+      Cycle_Simulate(ir,chk,sigNodes,sigVals);
+      mismatches += Compare_States(ir,st,chk,time);
     }
-    // printing Intermediate values
-    for (nI =flatCell->getNodes().begin(); nI != flatCell->getNodes().end(); nI++){
-      hcmNode *node= nI->second;
-      if(IsGlobalNode(node,globalNodes)){
-        continue;
-      }
-      string node_name=node->getName();
-      bool newVal;
-      node->getProp("cur_val",newVal);
-      // cout << node_name<<" = "<<newVal <<endl;
-      hcmNodeCtx *nodeCtx = new hcmNodeCtx(noInsts,node);
-      if (nodeCtx) {
-        vcd.changeValue(nodeCtx, newVal);
-        delete nodeCtx;
-      }
+    // printing the nodes which changed, the event driven engine tracks them itself
+    if (engine != ENGINE_TIMED) {
+      vcd.changeTime(time);
+      vcd.dumpChanges(st, engine == ENGINE_EVENT || engine == ENGINE_CHECK);
     }
     time++; 
+    if (!monitors.empty() && !monitors.check(st, time-1)) {
+      cout << "-I- Stopped at time " << time-1 << " on a monitor failure" << endl;
+      break;
+    }
+    if (ckptEvery && time % ckptEvery == 0) {
+      ckptPosition at = { time, stim.offset(), stim.lineNum() };
+      if (!writeCheckpoint(cellName + "_" + to_string(time) + ".ckpt", ir, st, at)) {
+        exit(1);
+      }
+    }
     // cout << "-I- Reading next vectors ... " << endl;
   }
 
+  delete psim;
+  if (tsim) {
+    tsim->finish(st, vcd);
+    delete tsim;
+  }
+  if (randomVectors) {
+    // throughput of the engine alone, the stimulus is generated in process
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - simStart).count();
+    printf("-I- Simulated %u random vectors in %.3f sec: %.0f vectors/sec", time, sec, time / sec);
+    if (!st.toggles.empty()) {
+      unsigned long long events = 0;
+      for (int n = 0; n < ir.numNodes; n++) {
+        events += st.toggles[n];
+      }
+      printf(", %llu events, %.0f events/sec", events, events / sec);
+    }
+    printf("\n");
+  }
+  delete wave;
+  if (stim.failed()) {
+    return(1);
+  }
+  if (!monitors.empty()) {
+    monitors.summary();
+    if (monitors.failures) {
+      return(1);
+    }
+  }
+  if (activity && !writeActivity(cellName + ".saif", ir, cellName, st, capLoad,
+                                 engine == ENGINE_TIMED ? (unsigned long long)time*period : time, timescale)) {
+    return(1);
+  }
+  if (engine == ENGINE_CHECK) {
+    if (mismatches) {
+      cerr << "-E- cycle engine differs from the event driven engine in " << mismatches << " node values" << endl;
+      return(1);
+    }
+    cout << "-I- cycle engine matches the event driven engine on " << time << " vectors" << endl;
+  }
   return(0);
 }
  
 
 /* functions implementation*/
 
-// Gate processor function, reponsible of simulation of instances from GateQueue 
-// and follow that, adding new events to EventQueue
-void Gate_Processor(std::queue< Event > &EventQueue,std::queue<hcmInstance *> &GateQueue){
-  while(!GateQueue.empty()){
-    hcmInstance *inst=GateQueue.front();
-    // simulating the instance, and updating EventQueue accordingly
-    Simulate_Gate(inst,EventQueue);
-    //removing the instance from GateQueue
-    GateQueue.pop();
+/*
+  Event driven simulation of one vector: schedule the input events and run
+  delta cycles (apply events, evaluate the gates in their fanout) until no
+  event is left. The first vector evaluates every instance once so all nodes
+  agree with the inputs (replaces the first_run property, nodes which do not
+  change are still settled).
+  The clock edges are only looked at once the vector settled, so a glitch
+  of a gated clock in the middle of the delta cycles clocks nothing: the
+  domains whose settled clock rose are clocked (lowest clock stage first,
+  their outputs may move the clock of a divided domain) and the vector
+  settles again, until no domain is left. Then the dffs sample D, as in
+  the cycle engine.
+*/
+void Event_Simulate(const simIR &ir,simState &st,simScheduler &sched,
+  vector<int> &sigNodes,vector<char> &sigVals,bool first){
+  saveClocks(ir,st.val,st.prevVal);
+  st.fired.assign(ir.clocks.size(),0);
+  for(size_t s=0; s<sigNodes.size(); s++){
+    sched.scheduleEvent(sigNodes[s],sigVals[s]);
+  }
+  if(first){
+    Event_Processor(ir,st,sched);
+    for(int i=0; i<ir.numInsts; i++){
+      sched.scheduleGate(i);
+    }
+    Gate_Processor(ir,st,sched);
   }
+  do {
+    while(!sched.events.empty()){
+      Event_Processor(ir,st,sched);
+      if(!sched.gates.empty()){
+        Gate_Processor(ir,st,sched);
+      }
+    }
+  } while(Clock_Edges(ir,st,sched));
+  Sample_Domains(ir,st);
 }
 
-
-// simulate OR gate ,return the result , and changes output_node accordingly
-bool logic_OR(hcmInstance *inst,hcmNode **output_node){
-  bool result=false;
-  std::map<std::string, hcmInstPort* >::const_iterator ipI;
-  for (ipI =inst->getInstPorts().begin(); ipI != inst->getInstPorts().end(); ipI++){
-    hcmInstPort* ip= ipI->second;
-    hcmNode* node= ip->getNode();
-    if(ip->getPort()->getDirection()==OUT){
-      *output_node=node;
-    }
-    if(ip->getPort()->getDirection()==IN){
-      bool temp_res;
-      if(node->getProp("cur_val",temp_res)==OK){
-        result=result || temp_res;
-      }
+/*
+  Levelized (oblivious) simulation of one vector: no events, every instance is
+  evaluated exactly once in ir.order. A dff comes after its CLK cone and on a
+  rising edge outputs the data it sampled, the dffs of the clock domains which
+  did not see an edge sample their (now settled) D input at the end of the vector.
+*/
+void Cycle_Simulate(const simIR &ir,simState &st,vector<int> &sigNodes,vector<char> &sigVals){
+  saveClocks(ir,st.val,st.prevVal);
+  for(size_t s=0; s<sigNodes.size(); s++){
+    st.val[sigNodes[s]]=sigVals[s];
+  }
+  for(size_t o=0; o<ir.order.size(); o++){
+    int inst=ir.order[o];
+    bool result;
+    switch(ir.type[inst]){
+      case CELL_NOR:    result=!logic_OR(ir,st,inst);     break;
+      case CELL_XNOR:   result=!logic_XOR(ir,st,inst);    break;
+      case CELL_XOR:    result=logic_XOR(ir,st,inst);     break;
+      case CELL_OR:     result=logic_OR(ir,st,inst);      break;
+      case CELL_NAND:   result=!logic_AND(ir,st,inst);    break;
+      case CELL_AND:    result=logic_AND(ir,st,inst);     break;
+      case CELL_BUFFER: result=logic_BUFFER(ir,st,inst);  break;
+      case CELL_INV:    result=!logic_BUFFER(ir,st,inst); break;
+      case CELL_DFF:
+        if(!DFF_Edge(ir,st,inst)){
+          continue;
+        }
+        result=st.dffState[inst];
+        break;
+      default:
+        cerr << "-E- unknown cell type of instance: " << ir.insts[inst]->getName() << " aborting." << endl;
+        exit(1);
     }
+    st.val[ir.out[inst]]=result;
   }
-  return result;
+  Sample_Domains(ir,st);
 }
 
-// simulate XOR gate ,return the result , and changes output_node accordingly
-bool logic_XOR(hcmInstance *inst,hcmNode **output_node){
-  bool result=false;
-  std::map<std::string, hcmInstPort* >::const_iterator ipI;
-  for (ipI =inst->getInstPorts().begin(); ipI != inst->getInstPorts().end(); ipI++){
-    hcmInstPort* ip= ipI->second;
-    hcmNode* node= ip->getNode();
-    if(ip->getPort()->getDirection()==OUT){
-      *output_node=node;
-    }
-    if(ip->getPort()->getDirection()==IN){
-      bool temp_res;
-      if(node->getProp("cur_val",temp_res)==OK){
-        result=result ^ temp_res;
-      }
+// end of a vector: the registers of the clock domains without an edge sample
+// their settled D input, one domain at a time
+void Sample_Domains(const simIR &ir,simState &st){
+  for(size_t d=0; d<ir.clocks.size(); d++){
+    if(domainEdge(ir,st,d)){
+      continue;
+    }
+    for(int k=ir.domainStart[d]; k<ir.domainStart[d+1]; k++){
+      int inst=ir.domainDffs[k];
+      st.dffState[inst]=st.val[ir.fanin[ir.faninStart[inst]]];
     }
   }
-  return result;
 }
 
-// simulate AND gate ,return the result , and changes output_node accordingly
-bool logic_AND(hcmInstance *inst,hcmNode **output_node){
-  bool result=true;
-  std::map<std::string, hcmInstPort* >::const_iterator ipI;
-  for (ipI =inst->getInstPorts().begin(); ipI != inst->getInstPorts().end(); ipI++){
-    hcmInstPort* ip= ipI->second;
-    hcmNode* node= ip->getNode();
-    if(ip->getPort()->getDirection()==OUT){
-      *output_node=node;
-    }
-    if(ip->getPort()->getDirection()==IN){
-      bool temp_res;
-      if(node->getProp("cur_val",temp_res)==OK){
-        result=result && temp_res;
+/*
+  compare the node values of two simulators after a vector,
+  print the first differences and return their number.
+*/
+int Compare_States(const simIR &ir,simState &st,simState &ref,unsigned int time){
+  int diff=0;
+  for(int n=0; n<ir.numNodes; n++){
+    if(st.val[n]!=ref.val[n]){
+      if(diff<10){
+        cerr << "-E- time " << time << " node " << ir.names[n] << ": event " << (int)st.val[n]
+             << " cycle " << (int)ref.val[n] << endl;
       }
+      diff++;
     }
   }
-  return result;
+  return diff;
 }
 
-// simulate BUFFER gate , return the result , and changes output_node accordingly
-bool logic_BUFFER(hcmInstance *inst,hcmNode **output_node){
+// Gate processor function, reponsible of simulation of the instances scheduled in this delta
+// and follow that, scheduling new events for the next delta
+void Gate_Processor(const simIR &ir,simState &st,simScheduler &sched){
+  for(size_t g=0; g<sched.gates.size(); g++){
+    // simulating the instance, and scheduling its output event accordingly
+    Simulate_Gate(ir,st,sched.gates[g],sched);
+  }
+  // all gates of the delta were evaluated, clear their marks at once
+  sched.clearGates();
+}
+
+
+// simulate OR gate over the instance inputs and return the result
+bool logic_OR(const simIR &ir,simState &st,int inst){
   bool result=false;
-  std::map<std::string, hcmInstPort* >::const_iterator ipI;
-  for (ipI =inst->getInstPorts().begin(); ipI != inst->getInstPorts().end(); ipI++){
-    hcmInstPort* ip= ipI->second;
-    hcmNode* node= ip->getNode();
-    if(ip->getPort()->getDirection()==OUT){
-      *output_node=node;
-    }
-    if(ip->getPort()->getDirection()==IN){
-      bool temp_res;
-      if(node->getProp("cur_val",temp_res)==OK){
-        result=temp_res;
-      }
-    }
+  for(int k=ir.faninStart[inst]; k<ir.faninStart[inst+1]; k++){
+    result=result || st.val[ir.fanin[k]];
   }
   return result;
 }
 
-// simulate DFF gate , return the result of output , and changes output_node accordingly
-// in addition it return CLK=true as an argument iff on rising edge.
-bool DFF(hcmInstance *inst,hcmNode **output_node,bool &CLK){
-  bool cur_clk=false,prev_clk=false;
-  bool data=false,cur_result=false;
-  // cout<< "######" << inst->getName() <<endl;
-  std::map<std::string, hcmInstPort* >::const_iterator ipI;
-  for (ipI =inst->getInstPorts().begin(); ipI != inst->getInstPorts().end(); ipI++){
-    hcmInstPort* ip= ipI->second;
-    hcmNode* node= ip->getNode();
-    if(ip->getPort()->getDirection()==OUT){
-      *output_node=node;
-      node->getProp("cur_val",cur_result);
-    }
-    if(ip->getPort()->getDirection()==IN){
-      bool temp_res;
-      if(ip->getPort()->getName()=="CLK"){
-        node->getProp("cur_val",cur_clk);
-        node->getProp("prev_CLK",prev_clk);
-        // cout<< "node "<<node->getName()<<" = "<< cur_clk  <<endl;
-      } else{
-        node->getProp("cur_val",data);
-        // node->getProp("prev_val",data);
-        // cout<< "(prev result) node "<<node->getName()<<" = "<< data  <<endl;
-      }
-    }
-  }
-  CLK=false;
-  if(cur_clk==true && prev_clk==false){
-    bool prev_data;
-    inst->getProp("prev_val", prev_data);
-    CLK=true;
-    return prev_data; 
+// simulate XOR gate over the instance inputs and return the result
+bool logic_XOR(const simIR &ir,simState &st,int inst){
+  bool result=false;
+  for(int k=ir.faninStart[inst]; k<ir.faninStart[inst+1]; k++){
+    result=result ^ (bool)st.val[ir.fanin[k]];
   }
-  inst->setProp("prev_val", data);
-  return cur_result;
+  return result;
 }
 
-// function responsible of simulating instance and incrementing EventQueue accordingly
-void Simulate_Gate(hcmInstance * inst,std::queue< Event > &EventQueue){
-  string logic_name= inst->masterCell()->getName();
-  hcmNode* output_node;
-  bool result, inverted=false,IsDFF=false,CLK=false;
-  if(logic_name.find("nor")!=std::string::npos){
-    result=!(logic_OR(inst,&output_node));
-    inverted=true;
-  } else if(logic_name.find("xor")!=std::string::npos){
-    result=logic_XOR(inst,&output_node);
-  } else if(logic_name.find("or")!=std::string::npos){
-    result=logic_OR(inst,&output_node);
-  } else if(logic_name.find("nand")!=std::string::npos){
-    result=!(logic_AND(inst,&output_node));
-    inverted=true;
-  } else if(logic_name.find("and")!=std::string::npos){
-    result=logic_AND(inst,&output_node);
-  } else if(logic_name.find("buffer")!=std::string::npos){
-    result=logic_BUFFER(inst,&output_node);
-  } else if(logic_name.find("inv")!=std::string::npos){
-    result=!(logic_BUFFER(inst,&output_node));
-    inverted=true;
-  } else if(logic_name.find("not")!=std::string::npos){
-    result=!(logic_BUFFER(inst,&output_node));
-    inverted=true;
-  } else if(logic_name.find("dff")!=std::string::npos){
-    result=DFF(inst,&output_node,CLK);
-    IsDFF=true;
-  } else{
-    cerr << "-E- does not support gate type: " << logic_name << " aborting." << endl;
-    exit(1);
+// simulate AND gate over the instance inputs and return the result
+bool logic_AND(const simIR &ir,simState &st,int inst){
+  bool result=true;
+  for(int k=ir.faninStart[inst]; k<ir.faninStart[inst+1]; k++){
+    result=result && st.val[ir.fanin[k]];
   }
-  //Applying the result to the output node
-  bool prev_val ;
-  bool first_run=false;
-  output_node->getProp("cur_val",prev_val);
-  output_node->getProp("first_run",first_run);
-  if(first_run){
-    if(IsDFF&&CLK){
-      output_node->setProp("first_run",false);
-      first_run=true;
-    }
-    else{
-      first_run=false;
-      if((result==0)&&inverted){
-        first_run=true;
-      }
+  return result;
+}
+
+// simulate BUFFER gate and return the result (value of the single input)
+bool logic_BUFFER(const simIR &ir,simState &st,int inst){
+  return st.val[ir.fanin[ir.faninStart[inst]]];
+}
+
+// return true iff the CLK input of the dff is on a rising edge in this vector
+// (every clock node keeps its value before the vector in prevVal)
+bool DFF_Edge(const simIR &ir,simState &st,int inst){
+  int clk_node=ir.fanin[ir.faninStart[inst]+1];
+  bool cur_clk=st.val[clk_node];
+  bool prev_clk=st.prevVal[clk_node];
+  return cur_clk==true && prev_clk==false;
+}
+
+// settled vector: the domains whose clock rose and which were not clocked yet in this
+// vector, of the lowest clock stage, are clocked. returns false when there are none left.
+bool Clock_Edges(const simIR &ir,simState &st,simScheduler &sched){
+  int stage=-1;
+  for(size_t d=0; d<ir.clocks.size(); d++){
+    if(!st.fired[d] && domainEdge(ir,st,d) && (stage<0 || ir.clockStage[d]<stage)){
+      stage=ir.clockStage[d];
     }
   }
-
-  // if output changes we push new event to EventQueue (Event-Driven approach)
-  if( prev_val!=result || first_run){
-    Event new_event(output_node,result);
-    EventQueue.push(new_event);
+  if(stage<0){
+    return false;
   }
+  for(size_t d=0; d<ir.clocks.size(); d++){
+    if(!st.fired[d] && domainEdge(ir,st,d) && ir.clockStage[d]==stage){
+      st.fired[d]=1;
+      Clock_Domain_Edge(ir,st,d,sched);
+    }
+  }
+  return true;
 }
 
-// Event processor function, reponsible of events from EventQueue 
-// and follow that, adding new gates to GateQueue
-void Event_Processor(std::queue< Event > &EventQueue,std::queue<hcmInstance *> &GateQueue){
-  while(!EventQueue.empty()){
-    Event E=EventQueue.front();
-    hcmNode *node=E.Node;
-    bool new_val = E.val;
-
-    // copying new value to the Event's node 
-    bool temp=false;
-    node->setProp("cur_val",new_val);
-
-    // Iterating on Instances in the fanout of the node and pushing them to GateQueue
-    std::map<std::string, hcmInstPort* >::const_iterator ipI;
-    for (ipI =node->getInstPorts().begin(); ipI != node->getInstPorts().end(); ipI++){
-      hcmInstPort *ip= ipI->second;
-      hcmInstance *inst=ip->getInst();
-      if(ip->getPort()->getDirection()==IN){
-        if(!Gate_Exist(GateQueue,inst->getName())){
-          GateQueue.push(inst);
-        }
-      }
+// rising edge of a clock domain: all its registers output their sampled data at once,
+// as events of the next delta
+void Clock_Domain_Edge(const simIR &ir,simState &st,int domain,simScheduler &sched){
+  for(int k=ir.domainStart[domain]; k<ir.domainStart[domain+1]; k++){
+    int inst=ir.domainDffs[k];
+    if(st.val[ir.out[inst]]!=st.dffState[inst]){
+      sched.scheduleEvent(ir.out[inst],st.dffState[inst]);
     }
-    //removing E from EventQueue
-    EventQueue.pop();
   }
+}
 
+// simulate DFF gate , return the result of output.
+// fanin of a dff is {D, CLK}, the data sampled at the end of the previous
+// vector is kept in st.dffState (Sample_Domains). the output only changes
+// when the domain is clocked (Clock_Edges), evaluating the dff keeps it.
+bool DFF(const simIR &ir,simState &st,int inst){
+  return st.val[ir.out[inst]];
 }
 
-/*
-  return true if instance with name inst_name exist in the GateQueue.
-  note: calling GateQueue by value so that Copy C'tor is called.
-*/
-bool Gate_Exist(std::queue<hcmInstance *> GateQueue,string inst_name){
-  while(!GateQueue.empty()){
-    hcmInstance * inst=GateQueue.front();
-    GateQueue.pop();
-    if(inst->getName()==inst_name) return true;
+// function responsible of simulating instance and scheduling its output event accordingly
+void Simulate_Gate(const simIR &ir,simState &st,int inst,simScheduler &sched){
+  bool result;
+  switch(ir.type[inst]){
+    case CELL_NOR:    result=!logic_OR(ir,st,inst);     break;
+    case CELL_XNOR:   result=!logic_XOR(ir,st,inst);    break;
+    case CELL_XOR:    result=logic_XOR(ir,st,inst);     break;
+    case CELL_OR:     result=logic_OR(ir,st,inst);      break;
+    case CELL_NAND:   result=!logic_AND(ir,st,inst);    break;
+    case CELL_AND:    result=logic_AND(ir,st,inst);     break;
+    case CELL_BUFFER: result=logic_BUFFER(ir,st,inst);  break;
+    case CELL_INV:    result=!logic_BUFFER(ir,st,inst); break;
+    case CELL_DFF:    result=DFF(ir,st,inst);           break;
+    default:
+      cerr << "-E- unknown cell type of instance: " << ir.insts[inst]->getName() << " aborting." << endl;
+      exit(1);
+  }
+  // if output changes we schedule a new event (Event-Driven approach)
+  int output_node=ir.out[inst];
+  if((bool)st.val[output_node]!=result){
+    sched.scheduleEvent(output_node,result);
   }
-  return false;
 }
 
-/*
-returns true if Node is a global Node
-*/
-bool IsGlobalNode(hcmNode *Node,set< string> &globalNodes){
-  string nodeName=Node->getName();
-  return (globalNodes.find(nodeName) != globalNodes.end());
+// Event processor function, reponsible of applying the events of this delta
+// and follow that, scheduling the gates in their fanout.
+// events which (after collapsing) do not change the node value are dropped.
+// the dffs are not scheduled, a domain is clocked as a whole once the vector
+// settled (Clock_Edges).
+void Event_Processor(const simIR &ir,simState &st,simScheduler &sched){
+  for(size_t e=0; e<sched.events.size(); e++){
+    int node=sched.events[e];
+    char new_val=sched.eventVal[node];
+    if(st.val[node]==new_val){
+      continue;
+    }
+    // copying new value to the Event's node 
+    st.val[node]=new_val;
+    st.markChanged(node);
+    if(!st.toggles.empty()){
+      st.toggles[node]++;
+    }
+
+    // Iterating on Instances in the fanout of the node and scheduling them
+    for(int k=ir.fanoutStart[node]; k<ir.fanoutStart[node+1]; k++){
+      int inst=ir.fanout[k];
+      if(ir.type[inst]==CELL_DFF){
+        continue;
+      }
+      sched.scheduleGate(inst);
+    }
+  }
+  // all events of the delta were applied, clear their marks at once
+  sched.clearEvents();
 }
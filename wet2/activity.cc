@@ -0,0 +1,86 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <stdio.h>
+#include "activity.h"
+
+using namespace std;
+
+bool loadCapWeights(const string &fileName, const simIR &ir, vector<double> &load){
+  ifstream f(fileName.c_str());
+  if(!f.good()){
+    cerr << "-E- Could not open capacitance file: " << fileName << endl;
+    return false;
+  }
+  map<string, double> cells;
+  double def=1;
+  string l;
+  int lineNum=0;
+  while(getline(f, l)){
+    lineNum++;
+    size_t c=l.find('#');
+    if(c!=string::npos) l.erase(c);
+    istringstream ls(l);
+    string name;
+    double cap;
+    if(!(ls >> name)) continue;
+    if(!(ls >> cap) || cap<0){
+      cerr << "-E- " << fileName << ":" << lineNum << ": expected <cell> <capacitance>" << endl;
+      return false;
+    }
+    if(name=="*") def=cap;
+    else cells[name]=cap;
+  }
+  load.assign(ir.numNodes, 0);
+  for(int n=0; n<ir.numNodes; n++){
+    for(int k=ir.fanoutStart[n]; k<ir.fanoutStart[n+1]; k++){
+      map<string, double>::iterator I=cells.find(ir.cells[ir.fanout[k]]->name);
+      load[n]+=I==cells.end() ? def : I->second;
+    }
+  }
+  return true;
+}
+
+// SAIF identifiers escape the characters of the syntax
+static string saifName(const string &name){
+  string r;
+  for(size_t c=0; c<name.size(); c++){
+    if(name[c]=='[' || name[c]==']' || name[c]=='(' || name[c]==')' || name[c]=='\\') r+='\\';
+    r+=name[c];
+  }
+  return r;
+}
+
+bool writeActivity(const string &fileName, const simIR &ir, const string &cellName,
+                   const simState &st, const vector<double> &load,
+                   uint64_t duration, const string &timescale){
+  FILE *f=fopen(fileName.c_str(), "w");
+  if(!f){
+    cerr << "-E- Could not create activity file: " << fileName << endl;
+    return false;
+  }
+  size_t unit=timescale.find_first_not_of("0123456789");
+  fprintf(f, "(SAIFILE\n(SAIFVERSION \"2.0\")\n(DIRECTION \"backward\")\n(DESIGN \"%s\")\n", cellName.c_str());
+  fprintf(f, "(PROGRAM_NAME \"gl_sim\")\n(DIVIDER / )\n(TIMESCALE %s %s)\n(DURATION %llu)\n",
+          timescale.substr(0, unit).c_str(), timescale.substr(unit).c_str(), (unsigned long long)duration);
+  fprintf(f, "(INSTANCE %s\n  (NET\n", saifName(cellName).c_str());
+  uint64_t total=0;
+  double weighted=0;
+  for(int n=0; n<ir.numNodes; n++){
+    if(ir.isGlobal[n]) continue;
+    total+=st.toggles[n];
+    fprintf(f, "    (%s\n      (TC %llu)", saifName(ir.names[n]).c_str(), (unsigned long long)st.toggles[n]);
+    if(!load.empty()){
+      weighted+=st.toggles[n]*load[n];
+      fprintf(f, " (TW %g)", st.toggles[n]*load[n]);
+    }
+    fprintf(f, "\n    )\n");
+  }
+  fprintf(f, "  )\n)\n)\n");
+  fclose(f);
+  cout << "-I- Switching activity written to " << fileName << ": " << total << " toggles";
+  if(!load.empty()) cout << ", weighted " << weighted;
+  cout << endl;
+  return true;
+}
@@ -0,0 +1,34 @@
+#ifndef ACTIVITY_H
+#define ACTIVITY_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "simIR.h"
+
+/*
+  Switching activity of a run (-activity / -caps file).
+  The event processors count the value changes of every node in
+  st.toggles, a dense array indexed by node id (empty when not requested),
+  so the counting is one increment per applied event. At the end of the run
+  the counts are written as a SAIF-like report, cell.saif:
+    (SAIFILE ... (DURATION d) (INSTANCE cell (NET (name (TC n) (TW w)) ...)))
+  TC is the toggle count and TW, written when a capacitance file is given,
+  the toggle count weighted by the load of the node: the sum of the
+  capacitance weights of the cells reading it.
+
+  Capacitance file, one entry per line, '#' starts a comment:
+    nand2 1.5                input pin load of a master cell
+    * 1                      load of the cells not listed (default 1)
+*/
+
+// node id -> load, returns false (after printing -E-) on a bad capacitance file
+bool loadCapWeights(const std::string &fileName, const simIR &ir, std::vector<double> &load);
+
+// write the toggle counts of st (and weighted counts when load is not empty),
+// returns false (after printing -E-) when the file can not be created
+bool writeActivity(const std::string &fileName, const simIR &ir, const std::string &cellName,
+                   const simState &st, const std::vector<double> &load,
+                   uint64_t duration, const std::string &timescale);
+
+#endif
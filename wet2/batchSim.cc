@@ -0,0 +1,102 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+#include "batchSim.h"
+#include "vcdWriter.h"
+#include "glwWriter.h"
+
+using namespace std;
+
+bool readManifest(const string &fileName, vector<batchJob> &jobs){
+  ifstream f(fileName.c_str());
+  if(!f.good()){
+    cerr << "-E- Could not open batch manifest: " << fileName << endl;
+    return false;
+  }
+  string l;
+  int lineNum=0;
+  while(getline(f, l)){
+    lineNum++;
+    size_t c=l.find('#');
+    if(c!=string::npos) l.erase(c);
+    istringstream ls(l);
+    batchJob job;
+    string extra;
+    if(!(ls >> job.sigs)) continue;
+    if(!(ls >> job.vecs >> job.out) || (ls >> extra)){
+      cerr << "-E- " << fileName << ":" << lineNum << ": expected <sigFile> <vecFile> <out.vcd>" << endl;
+      return false;
+    }
+    job.vectors=0;
+    job.sec=0;
+    job.ok=false;
+    jobs.push_back(job);
+  }
+  if(jobs.empty()){
+    cerr << "-E- batch manifest " << fileName << " lists no testbench" << endl;
+    return false;
+  }
+  return true;
+}
+
+// one testbench, on the calling worker thread
+static void runJob(const simIR &ir, batchJob &job, bool hcmStim, bool glw, const string &cellName,
+                   testbenchFn &run){
+  chrono::steady_clock::time_point start=chrono::steady_clock::now();
+  stimReader stim;
+  if(!stim.open(job.sigs, job.vecs, ir, hcmStim, false)) return;
+  waveWriter *wave;
+  if(glw) wave=new glwWriter(job.out, ir, cellName);
+  else wave=new vcdWriter(job.out, ir, cellName);
+  if(!wave->good()){
+    cerr << "-E- Could not create waveform file: " << job.out << endl;
+    delete wave;
+    return;
+  }
+  job.vectors=run(stim, *wave);
+  delete wave;
+  job.ok=!stim.failed();
+  job.sec=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+}
+
+int runBatch(const simIR &ir, vector<batchJob> &jobs, int threads, bool hcmStim, bool glw,
+             const string &cellName, testbenchFn run){
+  chrono::steady_clock::time_point start=chrono::steady_clock::now();
+  if(threads<1) threads=1;
+  if((size_t)threads>jobs.size()) threads=jobs.size();
+  atomic<size_t> next(0);
+  auto worker=[&](){
+    for(size_t j=next++; j<jobs.size(); j=next++){
+      runJob(ir, jobs[j], hcmStim, glw, cellName, run);
+    }
+  };
+  vector<thread> workers;
+  for(int t=1; t<threads; t++){
+    workers.push_back(thread(worker));
+  }
+  worker();
+  for(size_t t=0; t<workers.size(); t++){
+    workers[t].join();
+  }
+  double sec=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+
+  int failed=0;
+  unsigned long vectors=0;
+  for(size_t j=0; j<jobs.size(); j++){
+    if(jobs[j].ok){
+      printf("-I- %s %s -> %s: %lu vectors (%.3f sec)\n", jobs[j].sigs.c_str(), jobs[j].vecs.c_str(),
+             jobs[j].out.c_str(), jobs[j].vectors, jobs[j].sec);
+    } else {
+      printf("-E- %s %s -> %s: failed\n", jobs[j].sigs.c_str(), jobs[j].vecs.c_str(), jobs[j].out.c_str());
+      failed++;
+    }
+    vectors+=jobs[j].vectors;
+  }
+  printf("-I- Batch: %zu testbenches, %d failed, %lu vectors on %d threads (%.3f sec)\n",
+         jobs.size(), failed, vectors, threads, sec);
+  return failed;
+}
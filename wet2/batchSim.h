@@ -0,0 +1,39 @@
+#ifndef BATCH_SIM_H
+#define BATCH_SIM_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "simIR.h"
+#include "stimReader.h"
+#include "waveWriter.h"
+
+/*
+  Batch simulation of many testbenches over one design (-batch manifest).
+  The verilog is parsed, flattened and compiled into the simIR once, then
+  the testbenches of the manifest are handed out to `threads` worker
+  threads. Each testbench has its own stimulus reader, waveform writer and
+  simulation state over the shared read-only ir.
+
+  Manifest, one testbench per line, '#' starts a comment:
+    sigFile vecFile out.vcd
+*/
+struct batchJob {
+  std::string sigs, vecs, out;
+  unsigned long vectors;              // vectors simulated
+  double sec;
+  bool ok;
+};
+
+// simulate every vector of stim into wave, returns the number of vectors
+typedef std::function<unsigned long(stimReader &stim, waveWriter &wave)> testbenchFn;
+
+// returns false (after printing -E-) on an unreadable or malformed manifest
+bool readManifest(const std::string &fileName, std::vector<batchJob> &jobs);
+
+// run the jobs on threads workers, glw selects the binary waveform format.
+// prints one line per testbench and returns the number of failed ones.
+int runBatch(const simIR &ir, std::vector<batchJob> &jobs, int threads, bool hcmStim, bool glw,
+             const std::string &cellName, testbenchFn run);
+
+#endif
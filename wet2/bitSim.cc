@@ -0,0 +1,228 @@
+#include <iostream>
+#include "bitSim.h"
+#include "laneWord.h"
+#include "simSched.h"
+
+using namespace std;
+
+/*
+  Event driven simulator over lane words. Same algorithm as the scalar
+  simulator in HW2ex1.cc, an event is scheduled when any lane of the output
+  word changes. The dffs are not scheduled: once the vector settled the
+  domains whose settled clock rose are clocked in the lanes of the edge
+  (lowest clock stage first) and the vector settles again, then the dffs of
+  the lanes without an edge sample D (Clock_Edges / Sample_Domains).
+*/
+template<int W>
+class bitSimulator {
+  public:
+    typedef laneWord<W> word;
+
+    bitSimulator(simIR &ir_) : ir(ir_){
+      val.assign(ir.numNodes, word::zero());
+      prevVal.assign(ir.numNodes, word::zero());
+      dffState.assign(ir.numInsts, word::zero());
+      fired.assign(ir.clocks.size(), word::zero());
+      if(ir.vddNode>=0){
+        val[ir.vddNode]=word::ones();
+        prevVal[ir.vddNode]=word::ones();
+      }
+      sched.init(ir.numNodes, ir.numInsts);
+    }
+
+    // apply one word per signal and settle all lanes, the first vector evaluates every instance
+    void simulateVector(const vector<word> &inputs, const vector<int> &sigNodes, bool first){
+      saveClocks(ir, val, prevVal);
+      fired.assign(ir.clocks.size(), word::zero());
+      for(size_t s=0; s<sigNodes.size(); s++){
+        sched.scheduleEvent(sigNodes[s], inputs[s]);
+      }
+      if(first){
+        processEvents();
+        for(int i=0; i<ir.numInsts; i++){
+          sched.scheduleGate(i);
+        }
+        processGates();
+      }
+      do {
+        while(!sched.events.empty()){
+          processEvents();
+          if(!sched.gates.empty()){
+            processGates();
+          }
+        }
+      } while(clockEdges());
+      sampleDomains();
+    }
+
+    vector<word> val;
+
+  private:
+    simIR &ir;
+    vector<word> prevVal;
+    vector<word> dffState;
+    vector<word> fired;                 // domain -> lanes clocked in the current vector
+    deltaScheduler<word> sched;
+
+    void processEvents(){
+      for(size_t e=0; e<sched.events.size(); e++){
+        int node=sched.events[e];
+        const word &new_val=sched.eventVal[node];
+        if(val[node]==new_val){
+          continue;
+        }
+        val[node]=new_val;
+        for(int k=ir.fanoutStart[node]; k<ir.fanoutStart[node+1]; k++){
+          if(ir.type[ir.fanout[k]]==CELL_DFF){
+            continue;
+          }
+          sched.scheduleGate(ir.fanout[k]);
+        }
+      }
+      sched.clearEvents();
+    }
+
+    void processGates(){
+      for(size_t g=0; g<sched.gates.size(); g++){
+        int inst=sched.gates[g];
+        word result=evaluate(inst);
+        int output_node=ir.out[inst];
+        if(val[output_node]!=result){
+          sched.scheduleEvent(output_node, result);
+        }
+      }
+      sched.clearGates();
+    }
+
+    word evaluate(int inst){
+      int first=ir.faninStart[inst], last=ir.faninStart[inst+1];
+      word r;
+      switch(ir.type[inst]){
+        case CELL_AND:
+        case CELL_NAND:
+          r=word::ones();
+          for(int k=first; k<last; k++) r=r&val[ir.fanin[k]];
+          return ir.type[inst]==CELL_NAND ? ~r : r;
+        case CELL_OR:
+        case CELL_NOR:
+          r=word::zero();
+          for(int k=first; k<last; k++) r=r|val[ir.fanin[k]];
+          return ir.type[inst]==CELL_NOR ? ~r : r;
+        case CELL_XOR:
+        case CELL_XNOR:
+          r=word::zero();
+          for(int k=first; k<last; k++) r=r^val[ir.fanin[k]];
+          return ir.type[inst]==CELL_XNOR ? ~r : r;
+        case CELL_BUFFER:
+          return val[ir.fanin[first]];
+        case CELL_INV:
+          return ~val[ir.fanin[first]];
+        case CELL_DFF:
+          // only changes when its domain is clocked (clockEdges)
+          return val[ir.out[inst]];
+        default:
+          cerr << "-E- unknown cell type of instance: " << ir.insts[inst]->getName() << " aborting." << endl;
+          exit(1);
+      }
+    }
+
+    // lanes in which the settled clock of a domain rose in this vector
+    word edge(int domain){
+      int clk_node=ir.clocks[domain];
+      return val[clk_node] & ~prevVal[clk_node];
+    }
+
+    // settled vector: the domains of the lowest clock stage with an edge not clocked yet
+    // (in any lane) output their sampled data in those lanes. returns false when none is left.
+    bool clockEdges(){
+      int stage=-1;
+      for(size_t d=0; d<ir.clocks.size(); d++){
+        if((edge(d) & ~fired[d])!=word::zero() && (stage<0 || ir.clockStage[d]<stage)){
+          stage=ir.clockStage[d];
+        }
+      }
+      if(stage<0){
+        return false;
+      }
+      for(size_t d=0; d<ir.clocks.size(); d++){
+        word rise=edge(d) & ~fired[d];
+        if(ir.clockStage[d]!=stage || rise==word::zero()){
+          continue;
+        }
+        fired[d]=fired[d] | rise;
+        for(int k=ir.domainStart[d]; k<ir.domainStart[d+1]; k++){
+          int inst=ir.domainDffs[k];
+          word q=(rise & dffState[inst]) | (~rise & val[ir.out[inst]]);
+          if(q!=val[ir.out[inst]]){
+            sched.scheduleEvent(ir.out[inst], q);
+          }
+        }
+      }
+      return true;
+    }
+
+    // end of a vector: the dffs sample their settled D in the lanes without an edge
+    void sampleDomains(){
+      for(size_t d=0; d<ir.clocks.size(); d++){
+        word rise=edge(d);
+        for(int k=ir.domainStart[d]; k<ir.domainStart[d+1]; k++){
+          int inst=ir.domainDffs[k];
+          dffState[inst]=(rise & dffState[inst]) | (~rise & val[ir.fanin[ir.faninStart[inst]]]);
+        }
+      }
+    }
+};
+
+template<int W>
+static bool runLanes(simIR &ir, stimReader &stim, int dumpLane, waveWriter &vcd){
+  typedef laneWord<W> word;
+  const int lanes=64*W;
+  vector<int> &sigNodes=stim.nodes;
+  size_t nsigs=sigNodes.size();
+
+  // read all vectors, one byte per signal, to cut them into the lane segments
+  vector<char> rows, vals;
+  while (stim.next(vals)) {
+    rows.insert(rows.end(), vals.begin(), vals.end());
+  }
+  if(stim.failed()) return false;
+  size_t nrows = nsigs ? rows.size()/nsigs : 0;
+  if(nrows==0){
+    cerr << "-W- no vectors to simulate" << endl;
+    return true;
+  }
+  size_t seg=(nrows+lanes-1)/lanes;
+  cout << "-I- Simulating " << nrows << " vectors in " << lanes << " lanes of "
+       << seg << " vectors" << endl;
+
+  bitSimulator<W> sim(ir);
+  vector<word> inputs(nsigs, word::zero());
+  for(size_t t=0; t<seg; t++){
+    // lane j takes row j*seg+t, lanes past the end of the file repeat the last row
+    for(int j=0; j<lanes; j++){
+      size_t row=j*seg+t;
+      if(row>=nrows) row=nrows-1;
+      const char *r=&rows[row*nsigs];
+      for(size_t s=0; s<nsigs; s++){
+        inputs[s].setLane(j, r[s]);
+      }
+    }
+    sim.simulateVector(inputs, sigNodes, t==0);
+
+    vcd.changeTime(t);
+    for (int n=0; n<ir.numNodes; n++){
+      vcd.changeValue(n, sim.val[n].lane(dumpLane));
+    }
+  }
+  return true;
+}
+
+bool runBitParallel(simIR &ir, stimReader &stim, int lanes, int dumpLane, waveWriter &vcd){
+  switch(lanes){
+    case 64:  return runLanes<1>(ir, stim, dumpLane, vcd);
+    case 256: return runLanes<4>(ir, stim, dumpLane, vcd);
+    case 512: return runLanes<8>(ir, stim, dumpLane, vcd);
+  }
+  cerr << "-E- unsupported number of lanes: " << lanes << " (64, 256 or 512)" << endl;
+  return false;
+}
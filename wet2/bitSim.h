@@ -0,0 +1,23 @@
+#ifndef BIT_SIM_H
+#define BIT_SIM_H
+
+#include <string>
+#include <vector>
+#include "waveWriter.h"
+#include "stimReader.h"
+#include "simIR.h"
+
+/*
+  Bit-parallel pattern simulation: 64, 256 or 512 independent simulations
+  packed into lane words. The vector file is cut into `lanes` consecutive
+  segments of equal length and lane j simulates segment j from the initial
+  state (own dff state and clock history per lane), so every gate evaluation
+  is a few bitwise operations for all lanes together.
+  Clocks behave as in -engine event: a domain is clocked in a lane once the
+  vector settled there with its clock risen (gated and divided clocks
+  included), so every lane matches the event engine on its segment.
+  Only lane dumpLane is written to the waveform, its time starts at 0.
+*/
+bool runBitParallel(simIR &ir, stimReader &stim, int lanes, int dumpLane, waveWriter &vcd);
+
+#endif
@@ -0,0 +1,139 @@
+#include <iostream>
+#include <stdio.h>
+#include <string.h>
+#include "checkpoint.h"
+#include "glwFormat.h"
+
+using namespace std;
+
+// FNV-1a over the node names, cell types and connectivity, so a checkpoint
+// is only restored into the netlist it was taken from
+static uint32_t netlistHash(const simIR &ir){
+  uint32_t h = 2166136261u;
+  for(int n=0; n<ir.numNodes; n++){
+    for(size_t c=0; c<=ir.names[n].size(); c++){
+      h = (h ^ (unsigned char)ir.names[n].c_str()[c]) * 16777619u;
+    }
+  }
+  for(int i=0; i<ir.numInsts; i++){
+    h = (h ^ (unsigned char)ir.type[i]) * 16777619u;
+    for(int k=ir.faninStart[i]; k<ir.faninStart[i+1]; k++){
+      h = (h ^ (uint32_t)ir.fanin[k]) * 16777619u;
+    }
+  }
+  return h;
+}
+
+// bit b of every value, 8 per byte
+static void putPlane(vector<unsigned char> &buf, const vector<char> &vals, int b){
+  size_t start = buf.size();
+  buf.resize(start + (vals.size()+7)/8, 0);
+  for(size_t i=0; i<vals.size(); i++){
+    buf[start + i/8] |= ((vals[i] >> b) & 1) << (i%8);
+  }
+}
+
+// or bit b of vals from the plane at p
+static void getPlane(const unsigned char *&p, vector<char> &vals, int b){
+  for(size_t i=0; i<vals.size(); i++){
+    vals[i] |= ((p[i/8] >> (i%8)) & 1) << b;
+  }
+  p += (vals.size()+7)/8;
+}
+
+bool writeCheckpoint(const string &fileName, const simIR &ir, const simState &st, const ckptPosition &at){
+  bool fourState = !st.unk.empty();
+  vector<unsigned char> buf(CKPT_MAGIC, CKPT_MAGIC+8);
+  glwPutInt(buf, ir.numNodes, 4);
+  glwPutInt(buf, ir.numInsts, 4);
+  glwPutInt(buf, netlistHash(ir), 4);
+  glwPutInt(buf, fourState, 1);
+  glwPutInt(buf, at.time, 8);
+  glwPutInt(buf, at.offset, 8);
+  glwPutInt(buf, at.line, 8);
+  putPlane(buf, st.val, 0);
+  if(fourState) putPlane(buf, st.unk, 0);
+  vector<char> prevClk;
+  for(size_t c=0; c<ir.clocks.size(); c++){
+    prevClk.push_back(st.prevVal[ir.clocks[c]]);
+  }
+  putPlane(buf, prevClk, 0);
+  if(fourState) putPlane(buf, prevClk, 1);
+  vector<char> dffData;
+  for(int i=0; i<ir.numInsts; i++){
+    if(ir.type[i]==CELL_DFF) dffData.push_back(st.dffState[i]);
+  }
+  putPlane(buf, dffData, 0);
+  if(fourState) putPlane(buf, dffData, 1);
+
+  string tmpName = fileName + ".tmp";
+  FILE *f = fopen(tmpName.c_str(), "wb");
+  bool ok = f && fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+  if(f) ok = !fclose(f) && ok;
+  if(!ok || rename(tmpName.c_str(), fileName.c_str())){
+    cerr << "-E- Could not write checkpoint file: " << fileName << endl;
+    remove(tmpName.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool readCheckpoint(const string &fileName, const simIR &ir, simState &st, ckptPosition &at){
+  FILE *f = fopen(fileName.c_str(), "rb");
+  if(!f){
+    cerr << "-E- Could not open checkpoint file: " << fileName << endl;
+    return false;
+  }
+  vector<unsigned char> buf;
+  unsigned char chunk[65536];
+  size_t n;
+  while((n = fread(chunk, 1, sizeof(chunk), f)) > 0){
+    buf.insert(buf.end(), chunk, chunk+n);
+  }
+  fclose(f);
+
+  bool fourState = !st.unk.empty();
+  size_t dffs = 0;
+  for(int i=0; i<ir.numInsts; i++){
+    if(ir.type[i]==CELL_DFF) dffs++;
+  }
+  size_t need = 8+4+4+4+1+8+8+8 + ((ir.numNodes+7)/8 + (ir.clocks.size()+7)/8 + (dffs+7)/8) * (fourState ? 2 : 1);
+  if(buf.size() < 8 || memcmp(buf.data(), CKPT_MAGIC, 8)){
+    cerr << "-E- " << fileName << " is not a checkpoint file" << endl;
+    return false;
+  }
+  const unsigned char *p = buf.data() + 8;
+  if(buf.size() != need || glwGetInt(p, 4) != (uint64_t)ir.numNodes || glwGetInt(p+4, 4) != (uint64_t)ir.numInsts
+     || glwGetInt(p+8, 4) != netlistHash(ir) || glwGetInt(p+12, 1) != (uint64_t)fourState){
+    cerr << "-E- checkpoint " << fileName << " was not taken from this netlist"
+         << (fourState ? " in -4state mode" : " in two state mode") << endl;
+    return false;
+  }
+  p += 13;
+  at.time = glwGetInt(p, 8);
+  at.offset = glwGetInt(p+8, 8);
+  at.line = glwGetInt(p+16, 8);
+  p += 24;
+
+  st.val.assign(ir.numNodes, 0);
+  getPlane(p, st.val, 0);
+  if(fourState){
+    st.unk.assign(ir.numNodes, 0);
+    getPlane(p, st.unk, 0);
+  }
+  vector<char> prevClk(ir.clocks.size(), 0);
+  getPlane(p, prevClk, 0);
+  if(fourState) getPlane(p, prevClk, 1);
+  for(size_t c=0; c<ir.clocks.size(); c++){
+    st.prevVal[ir.clocks[c]] = prevClk[c];
+  }
+  vector<char> dffData(dffs, 0);
+  getPlane(p, dffData, 0);
+  if(fourState) getPlane(p, dffData, 1);
+  for(int i=0, d=0; i<ir.numInsts; i++){
+    if(ir.type[i]==CELL_DFF) st.dffState[i] = dffData[d++];
+  }
+  st.changed.clear();
+  st.isChanged.assign(ir.numNodes, 0);
+  return true;
+}
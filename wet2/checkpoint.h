@@ -0,0 +1,38 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <string>
+#include "simIR.h"
+
+/*
+  Snapshots of a simulation run (-checkpoint n / -resume file).
+  A checkpoint holds everything the zero delay engines carry from one vector
+  to the next: the node values, the data sampled by the dffs (prev_val), the
+  previous value of every clock node and the position of the next vector in
+  the vectors file.
+  Format (little endian, like glw):
+    "GLCKPT01", u32 numNodes, u32 numInsts, u32 netlist hash, u8 four state,
+    u64 vectors simulated, u64 vector file offset, u64 vector file line,
+    node value bit plane (numNodes bits), unknown plane when four state,
+    previous clock values (one bit per clock domain), high bit plane when four state,
+    dff data bit plane (one bit per dff in instance order), high bit plane
+    when four state.
+  The file is written under a temporary name and renamed, so a crash while
+  writing leaves the previous checkpoints intact.
+*/
+#define CKPT_MAGIC "GLCKPT01"
+
+struct ckptPosition {
+  uint64_t time;                      // vectors simulated
+  uint64_t offset;                    // stimReader::offset() of the next vector
+  uint64_t line;                      // stimReader::lineNum() there
+};
+
+// returns false (after printing -E-) when the file can not be written
+bool writeCheckpoint(const std::string &fileName, const simIR &ir, const simState &st, const ckptPosition &at);
+// restores st (initialized for the same mode) and the position, returns false (after printing -E-)
+// on unreadable files or a checkpoint of another netlist or mode
+bool readCheckpoint(const std::string &fileName, const simIR &ir, simState &st, ckptPosition &at);
+
+#endif
@@ -0,0 +1,237 @@
+#include <dlfcn.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "codeGen.h"
+
+using namespace std;
+
+// statements per generated function, keeps the compile time of huge netlists sane
+#define CHUNK_SIZE 4096
+
+// expression of a combinational instance over v[] (values are 0/1)
+static string gateExpression(const simIR &ir, int inst){
+  ostringstream e;
+  int first=ir.faninStart[inst], last=ir.faninStart[inst+1];
+  const char *op=" & ";
+  bool invert=false;
+  switch(ir.type[inst]){
+    case CELL_NAND:   invert=true; // fall through
+    case CELL_AND:    op=" & "; break;
+    case CELL_NOR:    invert=true; // fall through
+    case CELL_OR:     op=" | "; break;
+    case CELL_XNOR:   invert=true; // fall through
+    case CELL_XOR:    op=" ^ "; break;
+    case CELL_INV:    invert=true; // fall through
+    case CELL_BUFFER: last=first+1; break;
+  }
+  if(invert) e << "!(";
+  if(first==last){
+    e << (ir.type[inst]==CELL_AND || ir.type[inst]==CELL_NAND ? "1" : "0");
+  }
+  for(int k=first; k<last; k++){
+    if(k>first) e << op;
+    e << "v[" << ir.fanin[k] << "]";
+  }
+  if(invert) e << ")";
+  return e.str();
+}
+
+// rising edge of the CLK input of a dff
+static string edgeExpression(const simIR &ir, int inst){
+  ostringstream e;
+  int clk_node=ir.fanin[ir.faninStart[inst]+1];
+  e << "v[" << clk_node << "] & !p[" << clk_node << "]";
+  return e.str();
+}
+
+// text of a /* */ comment: an escaped verilog name may hold "*/", "/*" or end in a backslash
+static string commentText(const string &name){
+  string r;
+  for(size_t i=0; i<name.size(); i++){
+    if(name[i]=='\\') r+="\\\\";
+    else if(name[i]=='/' && i && name[i-1]=='*') r+="\\/";
+    else if(name[i]=='*' && i && name[i-1]=='/') r+="\\*";
+    else r+=name[i];
+  }
+  return r;
+}
+
+/*
+  Layout of the generated source:
+    chunk_N()    - up to CHUNK_SIZE instances of ir.order each
+    sim_vector() - calls the chunks in order, then lets the dffs of the clock
+                   domains without an edge sample their D input
+  a dff in the order computes its edge flag and outputs its data on an edge.
+*/
+void writeSimSource(const simIR &ir, ostream &os){
+  os << "// generated by gl_sim, " << ir.numNodes << " nodes " << ir.numInsts << " instances\n";
+  os << "struct simPtrs { unsigned char *val, *prevVal, *dffState, *edge; };\n";
+  os << "typedef unsigned char u8;\n\n";
+  int chunks=0;
+  for(size_t o=0; o<ir.order.size(); o++){
+    if(o%CHUNK_SIZE==0){
+      if(o) os << "}\n\n";
+      os << "static void chunk_" << chunks++ << "(u8 *v, const u8 *p, u8 *d, u8 *e){\n";
+      os << "  (void)p; (void)d; (void)e;\n";
+    }
+    int inst=ir.order[o];
+    int out=ir.out[inst];
+    os << "  /* " << commentText(ir.insts[inst]->getName()) << " */\n";
+    if(ir.type[inst]==CELL_DFF){
+      os << "  if((e[" << inst << "] = " << edgeExpression(ir, inst) << ")) v[" << out << "] = d[" << inst << "];\n";
+    } else {
+      os << "  v[" << out << "] = " << gateExpression(ir, inst) << ";\n";
+    }
+  }
+  if(chunks) os << "}\n\n";
+  os << "extern \"C\" void sim_vector(struct simPtrs *s){\n";
+  os << "  u8 *v=s->val, *p=s->prevVal, *d=s->dffState, *e=s->edge;\n";
+  os << "  (void)p; (void)d; (void)e;\n";
+  for(int c=0; c<chunks; c++){
+    os << "  chunk_" << c << "(v, p, d, e);\n";
+  }
+  // every dff of a domain has the same edge flag
+  for(size_t c=0; c<ir.clocks.size(); c++){
+    os << "  if(!e[" << ir.domainDffs[ir.domainStart[c]] << "]){\n";
+    for(int k=ir.domainStart[c]; k<ir.domainStart[c+1]; k++){
+      int i=ir.domainDffs[k];
+      os << "    d[" << i << "] = v[" << ir.fanin[ir.faninStart[i]] << "];\n";
+    }
+    os << "  }\n";
+  }
+  os << "}\n";
+}
+
+// 64 bit FNV-1a
+static unsigned long long hashString(const string &s){
+  unsigned long long h=14695981039346656037ULL;
+  for(size_t i=0; i<s.size(); i++){
+    h^=(unsigned char)s[i];
+    h*=1099511628211ULL;
+  }
+  return h;
+}
+
+// whitespace separated words of a command line ($CXX may be "ccache g++")
+static void splitWords(const string &s, vector<string> &words){
+  istringstream is(s);
+  string w;
+  while(is >> w) words.push_back(w);
+}
+
+// run args[0] with its arguments, no shell in between so paths may hold any character
+static bool runCommand(const vector<string> &args){
+  vector<char*> argv;
+  for(size_t i=0; i<args.size(); i++){
+    argv.push_back((char*)args[i].c_str());
+  }
+  argv.push_back(NULL);
+  pid_t pid=fork();
+  if(pid<0) return false;
+  if(pid==0){
+    execvp(argv[0], &argv[0]);
+    _exit(127);
+  }
+  int status;
+  while(waitpid(pid, &status, 0)<0){
+    if(errno!=EINTR) return false;
+  }
+  return WIFEXITED(status) && WEXITSTATUS(status)==0;
+}
+
+compiledSim::compiledSim() : handle(0), fn(0) {}
+
+compiledSim::~compiledSim(){
+  if(handle) dlclose(handle);
+}
+
+bool compiledSim::load(const simIR &ir, const string &cacheDir){
+  const char *cxx=getenv("CXX");
+  string compiler = cxx ? cxx : "c++";
+  string flags = "-O1 -shared -fPIC";
+
+  ostringstream src;
+  writeSimSource(ir, src);
+  char hex[32];
+  snprintf(hex, sizeof(hex), "%016llx", hashString(src.str() + compiler + flags));
+  string base = cacheDir + "/sim_" + hex;
+  string soName = base + ".so";
+
+  if(mkdir(cacheDir.c_str(), 0777) && errno!=EEXIST){
+    cerr << "-E- Could not create cache directory: " << cacheDir << endl;
+    return false;
+  }
+  if(access(soName.c_str(), R_OK)==0){
+    cout << "-I- Using cached compiled netlist " << soName << endl;
+  } else {
+    // source and object under private names, the object is renamed when complete,
+    // so concurrent runs never share a file being written nor load a partial object
+    ostringstream priv;
+    priv << base << "." << getpid();
+    string srcName = priv.str() + ".cc";
+    string tmpName = priv.str() + ".so";
+    ofstream f(srcName.c_str());
+    if(!f.good()){
+      cerr << "-E- Could not open file:" << srcName << endl;
+      return false;
+    }
+    f << src.str();
+    f.close();
+    if(!f){
+      cerr << "-E- Could not write file:" << srcName << endl;
+      remove(srcName.c_str());
+      return false;
+    }
+    vector<string> cmd;
+    splitWords(compiler, cmd);
+    splitWords(flags, cmd);
+    cmd.push_back("-o");
+    cmd.push_back(tmpName);
+    cmd.push_back(srcName);
+    cout << "-I- Compiling netlist:";
+    for(size_t i=0; i<cmd.size(); i++){
+      cout << " '" << cmd[i] << "'";
+    }
+    cout << endl;
+    bool ok = !cmd.empty() && runCommand(cmd) && rename(tmpName.c_str(), soName.c_str())==0;
+    remove(srcName.c_str());
+    if(!ok){
+      cerr << "-E- Could not compile the generated netlist " << soName << endl;
+      remove(tmpName.c_str());
+      return false;
+    }
+  }
+
+  handle = dlopen(soName.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if(!handle){
+    cerr << "-E- Could not load " << soName << ": " << dlerror() << endl;
+    return false;
+  }
+  fn = (simVectorFn)dlsym(handle, "sim_vector");
+  if(!fn){
+    cerr << "-E- " << soName << " has no sim_vector: " << dlerror() << endl;
+    return false;
+  }
+  edge.assign(ir.numInsts, 0);
+  return true;
+}
+
+void compiledSim::simulate(const simIR &ir, simState &st, vector<int> &sigNodes, vector<char> &sigVals){
+  saveClocks(ir, st.val, st.prevVal);
+  for(size_t s=0; s<sigNodes.size(); s++){
+    st.val[sigNodes[s]]=sigVals[s];
+  }
+  struct simPtrs p;
+  p.val=(unsigned char*)&st.val[0];
+  p.prevVal=(unsigned char*)&st.prevVal[0];
+  p.dffState=(unsigned char*)(st.dffState.empty() ? 0 : &st.dffState[0]);
+  p.edge=edge.empty() ? 0 : &edge[0];
+  fn(&p);
+}
@@ -0,0 +1,47 @@
+#ifndef CODE_GEN_H
+#define CODE_GEN_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "simIR.h"
+
+/*
+  Compiled simulation: the levelized flat cell is emitted as a straight-line
+  C++ function (one expression per instance, in ir.order), compiled with the
+  system compiler ($CXX, default c++) into a shared object and loaded with
+  dlopen. The object is cached under the hash of the generated source, so a
+  second run on the same netlist skips the compile step.
+  The generated code works directly on the simState arrays, so its results
+  (and its dff data) are interchangeable with the other engines.
+*/
+
+// pointers handed to the generated sim_vector(), same layout in the generated source
+struct simPtrs {
+  unsigned char *val;
+  unsigned char *prevVal;
+  unsigned char *dffState;
+  unsigned char *edge;      // scratch: rising edge flag of every dff in this vector
+};
+
+typedef void (*simVectorFn)(struct simPtrs *s);
+
+// write the C++ source of the simulation function of a levelized ir
+void writeSimSource(const simIR &ir, std::ostream &os);
+
+class compiledSim {
+  public:
+    compiledSim();
+    ~compiledSim();
+    // generate, compile (unless found in cacheDir) and load the simulation function
+    bool load(const simIR &ir, const std::string &cacheDir);
+    // apply the signal values and simulate one vector
+    void simulate(const simIR &ir, simState &st, std::vector<int> &sigNodes, std::vector<char> &sigVals);
+
+  private:
+    void *handle;
+    simVectorFn fn;
+    std::vector<unsigned char> edge;
+};
+
+#endif
@@ -0,0 +1,232 @@
+#include <iostream>
+#include <fstream>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include "faultSim.h"
+
+using namespace std;
+
+/*
+  One worker: node values, clock history and dff data of 64 machines,
+  plus the stuck-at masks of the current group.
+*/
+class faultMachines {
+  public:
+    faultMachines(const simIR &ir_, const vector<int> &sigNodes_, const vector<char> &rows_)
+      : ir(ir_), sigNodes(sigNodes_), rows(rows_), sa0(ir_.numNodes, 0), sa1(ir_.numNodes, 0){}
+
+    size_t numRows() const { return sigNodes.empty() ? 0 : rows.size()/sigNodes.size(); }
+    // fault free values of the outputs pos after every vector
+    void simulateGood(const vector<int> &pos, vector<char> &goodPO);
+    // simulate the faults [first, first+n) (n <= 64), set their detection times
+    void simulateGroup(vector<faultResult> &faults, size_t first, size_t n,
+                       const vector<int> &pos, const vector<char> &goodPO);
+
+  private:
+    const simIR &ir;
+    const vector<int> &sigNodes;
+    const vector<char> &rows;           // vectors, one char per signal
+    vector<uint64_t> val, prevVal, dffState;
+    vector<uint64_t> sa0, sa1;          // node -> lanes stuck at 0 / 1
+    vector<int> faulted;                // nodes with a mask set
+
+    uint64_t force(int node, uint64_t v) const { return (v & ~sa0[node]) | sa1[node]; }
+    uint64_t evalWord(int inst) const;
+    uint64_t rise(int inst) const;
+    void reset();
+    void step(size_t t);
+};
+
+uint64_t faultMachines::evalWord(int inst) const{
+  int first=ir.faninStart[inst], last=ir.faninStart[inst+1];
+  uint64_t r;
+  switch(ir.type[inst]){
+    case CELL_AND:
+    case CELL_NAND:
+      r=~(uint64_t)0;
+      for(int k=first; k<last; k++) r&=val[ir.fanin[k]];
+      return ir.type[inst]==CELL_NAND ? ~r : r;
+    case CELL_OR:
+    case CELL_NOR:
+      r=0;
+      for(int k=first; k<last; k++) r|=val[ir.fanin[k]];
+      return ir.type[inst]==CELL_NOR ? ~r : r;
+    case CELL_XOR:
+    case CELL_XNOR:
+      r=0;
+      for(int k=first; k<last; k++) r^=val[ir.fanin[k]];
+      return ir.type[inst]==CELL_XNOR ? ~r : r;
+    case CELL_INV:
+      return ~val[ir.fanin[first]];
+    default:
+      return val[ir.fanin[first]];
+  }
+}
+
+// lanes with a rising edge on the CLK input of a dff
+uint64_t faultMachines::rise(int inst) const{
+  int clk_node=ir.fanin[ir.faninStart[inst]+1];
+  return val[clk_node] & ~prevVal[clk_node];
+}
+
+// initial state: all nodes 0, VDD 1, with the faults applied
+void faultMachines::reset(){
+  val.assign(ir.numNodes, 0);
+  prevVal.assign(ir.numNodes, 0);
+  dffState.assign(ir.numInsts, 0);
+  if(ir.vddNode>=0){
+    val[ir.vddNode]=prevVal[ir.vddNode]=~(uint64_t)0;
+  }
+  for(size_t f=0; f<faulted.size(); f++){
+    val[faulted[f]]=force(faulted[f], val[faulted[f]]);
+  }
+}
+
+// vector t in all lanes, levelized like Cycle_Simulate, every assigned node goes through its stuck-at masks
+void faultMachines::step(size_t t){
+  size_t nsigs=sigNodes.size();
+  saveClocks(ir, val, prevVal);
+  for(size_t s=0; s<nsigs; s++){
+    int node=sigNodes[s];
+    val[node]=force(node, rows[t*nsigs+s] ? ~(uint64_t)0 : 0);
+  }
+  for(size_t o=0; o<ir.order.size(); o++){
+    int inst=ir.order[o];
+    int out=ir.out[inst];
+    if(ir.type[inst]==CELL_DFF){
+      // lanes with an edge output the sampled data, the others hold Q
+      uint64_t r=rise(inst);
+      if(r) val[out]=force(out, (r & dffState[inst]) | (~r & val[out]));
+      continue;
+    }
+    val[out]=force(out, evalWord(inst));
+  }
+  for(size_t o=0; o<ir.order.size(); o++){
+    int inst=ir.order[o];
+    if(ir.type[inst]!=CELL_DFF) continue;
+    uint64_t r=rise(inst);
+    dffState[inst]=(r & dffState[inst]) | (~r & val[ir.fanin[ir.faninStart[inst]]]);
+  }
+}
+
+void faultMachines::simulateGood(const vector<int> &pos, vector<char> &goodPO){
+  reset();
+  size_t nrows=numRows();
+  goodPO.assign(nrows*pos.size(), 0);
+  for(size_t t=0; t<nrows; t++){
+    step(t);
+    for(size_t p=0; p<pos.size(); p++){
+      goodPO[t*pos.size()+p]=val[pos[p]] & 1;
+    }
+  }
+}
+
+void faultMachines::simulateGroup(vector<faultResult> &faults, size_t first, size_t n,
+                                  const vector<int> &pos, const vector<char> &goodPO){
+  for(size_t f=0; f<faulted.size(); f++){
+    sa0[faulted[f]]=sa1[faulted[f]]=0;
+  }
+  faulted.clear();
+  uint64_t active=0;
+  for(size_t l=0; l<n; l++){
+    const faultResult &fr=faults[first+l];
+    (fr.stuckAt ? sa1 : sa0)[fr.node] |= (uint64_t)1<<l;
+    faulted.push_back(fr.node);
+    active |= (uint64_t)1<<l;
+  }
+  reset();
+
+  size_t nrows=numRows();
+  uint64_t detected=0;
+  for(size_t t=0; t<nrows && detected!=active; t++){
+    step(t);
+    // compare the outputs with the fault free machine, drop the detected faults
+    uint64_t diff=0;
+    for(size_t p=0; p<pos.size(); p++){
+      diff |= val[pos[p]] ^ (goodPO[t*pos.size()+p] ? ~(uint64_t)0 : 0);
+    }
+    diff &= active & ~detected;
+    detected |= diff;
+    for(size_t l=0; diff; l++, diff>>=1){
+      if(diff & 1) faults[first+l].detected=t;
+    }
+  }
+}
+
+bool runFaultSim(const simIR &ir, stimReader &stim, int threads, const string &reportFile){
+  // primary outputs: nodes of output ports of the flat cell
+  vector<int> pos;
+  for(int n=0; n<ir.numNodes; n++){
+    hcmPort *port=ir.nodes[n]->getPort();
+    if(port && port->getDirection()==OUT) pos.push_back(n);
+  }
+  if(pos.empty()){
+    cerr << "-E- the top cell has no outputs to observe faults on" << endl;
+    return false;
+  }
+
+  vector<char> rows, vals;
+  while(stim.next(vals)){
+    rows.insert(rows.end(), vals.begin(), vals.end());
+  }
+  if(stim.failed()) return false;
+
+  vector<faultResult> faults;
+  for(int n=0; n<ir.numNodes; n++){
+    if(ir.isGlobal[n]) continue;
+    for(char sa=0; sa<2; sa++){
+      faultResult f={ n, sa, -1 };
+      faults.push_back(f);
+    }
+  }
+
+  chrono::steady_clock::time_point start=chrono::steady_clock::now();
+  vector<char> goodPO;
+  faultMachines good(ir, stim.nodes, rows);
+  good.simulateGood(pos, goodPO);
+
+  // groups of 64 faults handed out to the workers in order
+  size_t ngroups=(faults.size()+63)/64;
+  atomic<size_t> next(0);
+  auto worker=[&](){
+    faultMachines fm(ir, stim.nodes, rows);
+    for(size_t g=next++; g<ngroups; g=next++){
+      size_t first=g*64;
+      size_t n=faults.size()-first < 64 ? faults.size()-first : 64;
+      fm.simulateGroup(faults, first, n, pos, goodPO);
+    }
+  };
+  if(threads<1) threads=1;
+  vector<thread> workers;
+  for(int t=1; t<threads; t++){
+    workers.push_back(thread(worker));
+  }
+  worker();
+  for(size_t t=0; t<workers.size(); t++){
+    workers[t].join();
+  }
+  double sec=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+
+  size_t det=0;
+  for(size_t f=0; f<faults.size(); f++){
+    if(faults[f].detected>=0) det++;
+  }
+  printf("-I- Fault simulation: %zu vectors, %zu faults, %zu detected, coverage %.2f%% (%d threads, %.3f sec)\n",
+         good.numRows(), faults.size(), det, faults.size() ? 100.0*det/faults.size() : 0.0, threads, sec);
+
+  ofstream rep(reportFile.c_str());
+  if(!rep.good()){
+    cerr << "-E- Could not create fault report: " << reportFile << endl;
+    return false;
+  }
+  rep << "# node stuck-at first-detecting-vector (- = undetected)" << endl;
+  for(size_t f=0; f<faults.size(); f++){
+    rep << ir.names[faults[f].node] << " sa" << (int)faults[f].stuckAt << " ";
+    if(faults[f].detected>=0) rep << faults[f].detected << endl;
+    else rep << "-" << endl;
+  }
+  return true;
+}
@@ -0,0 +1,30 @@
+#ifndef FAULT_SIM_H
+#define FAULT_SIM_H
+
+#include <string>
+#include <vector>
+#include "simIR.h"
+#include "stimReader.h"
+
+/*
+  Stuck-at fault simulation (PPSFP style, fault parallel).
+  The fault list is a stuck-at-0 and a stuck-at-1 fault on every non-global
+  node. Faults are packed 64 per machine word, lane l of every node value
+  being the faulty machine of the group's fault l, and the whole vector file
+  is simulated levelized (same semantics as the cycle engine) once per group.
+  A fault is detected when a primary output of its machine differs from the
+  fault free machine; detected faults are dropped and a group stops as soon
+  as all of its faults are detected. The groups are shared by `threads`
+  worker threads, each with its own state over the read-only ir.
+*/
+struct faultResult {
+  int node;
+  char stuckAt;
+  long detected;                      // first detecting vector, -1 when undetected
+};
+
+// simulate all faults over the vectors of stim, prints the coverage and
+// writes one line per fault to reportFile. returns false on errors.
+bool runFaultSim(const simIR &ir, stimReader &stim, int threads, const std::string &reportFile);
+
+#endif
@@ -0,0 +1,152 @@
+#include "fourState.h"
+
+using namespace std;
+
+fourStateSim::fourStateSim(const simIR &ir_) : ir(ir_) {}
+
+void fourStateSim::init(simState &st, const vector<int> &sigNodes){
+  st.init(ir);
+  st.unk.assign(ir.numNodes, 1);
+  st.prevVal.assign(ir.numNodes, V4_X);
+  st.dffState.assign(ir.numInsts, V4_X);
+  vector<char> isInput(ir.numNodes, 0);
+  for(size_t s=0; s<sigNodes.size(); s++){
+    isInput[sigNodes[s]]=1;
+  }
+  for(int n=0; n<ir.numNodes; n++){
+    if(ir.isGlobal[n]){
+      st.unk[n]=0;
+    } else if(ir.driver[n]<0 && !isInput[n]){
+      st.val[n]=1;
+    }
+  }
+  sched.init(ir.numNodes, ir.numInsts);
+}
+
+/*
+  Same flow as Event_Simulate: schedule the input events, the first vector
+  evaluates every instance once, then delta cycles until no event is left,
+  the domains with a (possible) edge of their settled clock are clocked,
+  lowest stage first, and the dffs of the domains with no possible edge
+  sample D.
+*/
+void fourStateSim::simulate(simState &st, vector<int> &sigNodes, vector<char> &sigVals, bool first){
+  for(size_t c=0; c<ir.clocks.size(); c++){
+    st.prevVal[ir.clocks[c]]=st.value(ir.clocks[c]);
+  }
+  st.fired.assign(ir.clocks.size(), 0);
+  for(size_t s=0; s<sigNodes.size(); s++){
+    sched.scheduleEvent(sigNodes[s], sigVals[s]);
+  }
+  if(first){
+    eventProcessor(st);
+    for(int i=0; i<ir.numInsts; i++){
+      sched.scheduleGate(i);
+    }
+    gateProcessor(st);
+  }
+  do {
+    while(!sched.events.empty()){
+      eventProcessor(st);
+      if(!sched.gates.empty()){
+        gateProcessor(st);
+      }
+    }
+  } while(clockEdges(st));
+  sampleDomains(st);
+}
+
+// 0->1 of a domain clock is an edge, 0->X, X->1 and X->X are possible edges
+static bool possibleEdge(char prev_clk, char cur_clk){
+  return prev_clk!=V4_1 && cur_clk!=V4_0;
+}
+
+/*
+  Settled vector: clock the not yet clocked domains with a possible edge of
+  the lowest stage, returns false when there are none left. On an edge the
+  dffs output their data, on a possible edge an output turns X unless it
+  already holds the data.
+*/
+bool fourStateSim::clockEdges(simState &st){
+  int stage=-1;
+  for(size_t d=0; d<ir.clocks.size(); d++){
+    if(!st.fired[d] && possibleEdge(st.prevVal[ir.clocks[d]], st.value(ir.clocks[d])) &&
+       (stage<0 || ir.clockStage[d]<stage)){
+      stage=ir.clockStage[d];
+    }
+  }
+  if(stage<0) return false;
+  for(size_t d=0; d<ir.clocks.size(); d++){
+    char prev_clk=st.prevVal[ir.clocks[d]], cur_clk=st.value(ir.clocks[d]);
+    if(st.fired[d] || !possibleEdge(prev_clk, cur_clk) || ir.clockStage[d]!=stage) continue;
+    st.fired[d]=1;
+    bool edge=prev_clk==V4_0 && cur_clk==V4_1;
+    for(int k=ir.domainStart[d]; k<ir.domainStart[d+1]; k++){
+      int inst=ir.domainDffs[k];
+      char q=st.value(ir.out[inst]);
+      char code=(edge || q==st.dffState[inst]) ? st.dffState[inst] : V4_X;
+      if(code!=q){
+        sched.scheduleEvent(ir.out[inst], code);
+      }
+    }
+  }
+  return true;
+}
+
+// end of a vector: the dffs of the domains whose clock can not have risen sample their
+// settled D. after a possible edge the vector may or may not have clocked them, the data
+// stays known only where D agrees with it.
+void fourStateSim::sampleDomains(simState &st){
+  for(size_t d=0; d<ir.clocks.size(); d++){
+    char prev_clk=st.prevVal[ir.clocks[d]], cur_clk=st.value(ir.clocks[d]);
+    if(prev_clk==V4_0 && cur_clk==V4_1){
+      continue;
+    }
+    bool maybe=possibleEdge(prev_clk, cur_clk);
+    for(int k=ir.domainStart[d]; k<ir.domainStart[d+1]; k++){
+      int inst=ir.domainDffs[k];
+      char data=st.value(ir.fanin[ir.faninStart[inst]]);
+      if(data==V4_Z) data=V4_X;
+      st.dffState[inst]=(maybe && data!=st.dffState[inst]) ? V4_X : data;
+    }
+  }
+}
+
+// apply the events of this delta (value codes) and schedule the gates in their fanout
+void fourStateSim::eventProcessor(simState &st){
+  for(size_t e=0; e<sched.events.size(); e++){
+    int node=sched.events[e];
+    char code=sched.eventVal[node];
+    if(st.value(node)==code){
+      continue;
+    }
+    st.val[node]=code&1;
+    st.unk[node]=code>>1;
+    st.markChanged(node);
+    if(!st.toggles.empty()){
+      st.toggles[node]++;
+    }
+    // a dff only changes when its domain is clocked (clockEdges)
+    for(int k=ir.fanoutStart[node]; k<ir.fanoutStart[node+1]; k++){
+      if(ir.type[ir.fanout[k]]!=CELL_DFF) sched.scheduleGate(ir.fanout[k]);
+    }
+  }
+  sched.clearEvents();
+}
+
+// evaluate the gates of this delta and schedule their output events
+void fourStateSim::gateProcessor(simState &st){
+  for(size_t g=0; g<sched.gates.size(); g++){
+    int inst=sched.gates[g];
+    if(ir.type[inst]==CELL_DFF){
+      continue;                       // keeps its output until its domain is clocked
+    }
+    char v, u;
+    evalGate4(ir, &st.val[0], &st.unk[0], inst, v, u);
+    char code=v | u<<1;
+    if(st.value(ir.out[inst])!=code){
+      sched.scheduleEvent(ir.out[inst], code);
+    }
+  }
+  sched.clearGates();
+}
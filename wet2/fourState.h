@@ -0,0 +1,90 @@
+#ifndef FOUR_STATE_H
+#define FOUR_STATE_H
+
+#include <vector>
+#include "simIR.h"
+#include "simSched.h"
+
+/*
+  Four-state (0/1/X/Z) event driven simulation (-4state).
+  A node value is kept in two bit planes, st.val (value bit) and st.unk
+  (unknown bit): 0=(0,0) 1=(1,0) X=(0,1) Z=(1,1), the code val|unk<<1 is
+  what the scheduler and the waveform writers carry. Gates evaluate on the
+  planes with bitwise ops: an input is "known 0" = ~unk & ~val and "known 1"
+  = ~unk & val, a Z input reads as X and the output is X when it is neither
+  forced to 0 nor to 1, so a gate costs about two 2-state evaluations.
+  Every node starts as X (VDD/VSS known), nodes with no driver which are not
+  stimulus inputs are Z, and dffs hold X until they sample a known D.
+  A dff clocks on a 0->1 change of its CLK; on a possible edge (a clock
+  going 0->X or X->1) its output turns X unless it already holds the data,
+  and its data turns X unless D agrees with it.
+*/
+#define V4_0 0
+#define V4_1 1
+#define V4_X 2
+#define V4_Z 3
+
+// output planes (v, u) of a combinational instance over the node planes
+inline void evalGate4(const simIR &ir, const char *val, const char *unk, int inst, char &v, char &u){
+  int first=ir.faninStart[inst], last=ir.faninStart[inst+1];
+  char k0, k1, p, x;                  // output known 0 / known 1, xor parity / unknown
+  switch(ir.type[inst]){
+    case CELL_AND:
+    case CELL_NAND:
+      k0=0; k1=1;
+      for(int k=first; k<last; k++){
+        int n=ir.fanin[k];
+        k0|=(unk[n]^1)&(val[n]^1);
+        k1&=(unk[n]^1)&val[n];
+      }
+      break;
+    case CELL_OR:
+    case CELL_NOR:
+      k0=1; k1=0;
+      for(int k=first; k<last; k++){
+        int n=ir.fanin[k];
+        k0&=(unk[n]^1)&(val[n]^1);
+        k1|=(unk[n]^1)&val[n];
+      }
+      break;
+    case CELL_XOR:
+    case CELL_XNOR:
+      p=0; x=0;
+      for(int k=first; k<last; k++){
+        p^=val[ir.fanin[k]];
+        x|=unk[ir.fanin[k]];
+      }
+      k0=(x^1)&(p^1);
+      k1=(x^1)&p;
+      break;
+    default:
+      k0=(unk[ir.fanin[first]]^1)&(val[ir.fanin[first]]^1);
+      k1=(unk[ir.fanin[first]]^1)&val[ir.fanin[first]];
+  }
+  if(ir.cells[inst]->inverted()){
+    p=k0; k0=k1; k1=p;
+  }
+  v=k1;
+  u=(k0|k1)^1;
+}
+
+class fourStateSim {
+  public:
+    fourStateSim(const simIR &ir);
+
+    // every node X, undriven nodes which are not in sigNodes Z
+    void init(simState &st, const std::vector<int> &sigNodes);
+    // apply one vector (0/1 values) and run delta cycles until no event is left
+    void simulate(simState &st, std::vector<int> &sigNodes, std::vector<char> &sigVals, bool first);
+
+  private:
+    const simIR &ir;
+    simScheduler sched;               // event values are value codes
+
+    void eventProcessor(simState &st);
+    void gateProcessor(simState &st);
+    bool clockEdges(simState &st);
+    void sampleDomains(simState &st);
+};
+
+#endif
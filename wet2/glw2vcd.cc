@@ -0,0 +1,99 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "glwFormat.h"
+
+using namespace std;
+
+/*
+  glw2vcd: convert a gl_sim binary waveform (glw) back to vcd.
+  With -from/-to only the requested time window is converted: the block
+  index is used to seek to the first block holding the start time, its
+  snapshot gives the values at the block start.
+*/
+
+// same identifiers as the vcd written by gl_sim
+static string vcdId(int n){
+  string id;
+  do {
+    id += (char)('!' + n % 94);
+    n /= 94;
+  } while(n);
+  return id;
+}
+
+static const char vcdValue[4] = { '0', '1', 'x', 'z' };
+
+int main(int argc, char **argv){
+  int argIdx = 1;
+  unsigned long long from = 0, to = ~0ULL;
+  vector<string> files;
+  while(argIdx < argc){
+    if(!strcmp(argv[argIdx], "-from") && argIdx+1 < argc){
+      from = strtoull(argv[++argIdx], NULL, 10);
+    } else if(!strcmp(argv[argIdx], "-to") && argIdx+1 < argc){
+      to = strtoull(argv[++argIdx], NULL, 10);
+    } else {
+      files.push_back(argv[argIdx]);
+    }
+    argIdx++;
+  }
+  if(files.size() != 2){
+    cerr << "Usage: " << argv[0] << " [-from time] [-to time] file.glw out.vcd" << endl;
+    exit(1);
+  }
+
+  glwReader glw;
+  if(!glw.open(files[0])) exit(1);
+  FILE *out = fopen(files[1].c_str(), "w");
+  if(!out){
+    cerr << "-E- Could not create vcd file: " << files[1] << endl;
+    exit(1);
+  }
+  static char buf[1 << 20];
+  setvbuf(out, buf, _IOFBF, sizeof(buf));
+
+  size_t nsig = glw.names.size();
+  vector<string> ids(nsig);
+  fprintf(out, "$version gl_sim $end\n$timescale %s $end\n", glw.timescale.c_str());
+  fprintf(out, "$scope module %s $end\n", glw.cellName.c_str());
+  for(size_t s=0; s<nsig; s++){
+    ids[s] = vcdId(s);
+    fprintf(out, "$var wire 1 %s %s $end\n", ids[s].c_str(), glw.names[s].c_str());
+  }
+  fprintf(out, "$upscope $end\n$enddefinitions $end\n");
+
+  // values up to time "from" are folded into one initial dump at "from"
+  vector<char> val, snapshot;
+  vector<glwReader::change> changes;
+  bool started = false;
+  unsigned long long curTime = 0;
+  for(size_t b=glw.findBlock(from); b<glw.blocks.size() && glw.blocks[b].t0<=to; b++){
+    if(!glw.readBlock(b, snapshot, changes)) exit(1);
+    if(!started) val = snapshot;
+    size_t c = 0;
+    if(!started){
+      for(; c<changes.size() && changes[c].time<=from; c++){
+        val[changes[c].sig] = changes[c].val;
+      }
+      curTime = from > glw.blocks[b].t0 ? from : glw.blocks[b].t0;
+      fprintf(out, "#%llu\n", curTime);
+      for(size_t s=0; s<nsig; s++){
+        fprintf(out, "%c%s\n", vcdValue[(int)val[s]], ids[s].c_str());
+      }
+      started = true;
+    }
+    for(; c<changes.size() && changes[c].time<=to; c++){
+      if(changes[c].time != curTime){
+        curTime = changes[c].time;
+        fprintf(out, "#%llu\n", curTime);
+      }
+      fprintf(out, "%c%s\n", vcdValue[(int)changes[c].val], ids[changes[c].sig].c_str());
+    }
+  }
+  fclose(out);
+  return 0;
+}
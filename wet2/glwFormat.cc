@@ -0,0 +1,135 @@
+#include <iostream>
+#include <algorithm>
+#include <string.h>
+#include <zlib.h>
+#include "glwFormat.h"
+
+using namespace std;
+
+glwReader::~glwReader(){
+  if(f) fclose(f);
+}
+
+static bool readBytes(FILE *f, vector<unsigned char> &b, size_t n){
+  b.resize(n);
+  return fread(b.data(), 1, n, f) == n;
+}
+
+bool glwReader::open(const string &fileName){
+  f = fopen(fileName.c_str(), "rb");
+  if(!f){
+    cerr << "-E- Could not open waveform file: " << fileName << endl;
+    return false;
+  }
+  vector<unsigned char> b;
+  // index trailer
+  if(fseek(f, -16, SEEK_END) || !readBytes(f, b, 16) || memcmp(&b[8], GLW_INDEX_MAGIC, 8)){
+    cerr << "-E- " << fileName << " is not a complete glw file (missing index)." << endl;
+    return false;
+  }
+  long indexOffset = (long)glwGetInt(&b[0], 8);
+  if(fseek(f, indexOffset, SEEK_SET) || !readBytes(f, b, 4)){
+    cerr << "-E- corrupted index in " << fileName << endl;
+    return false;
+  }
+  size_t nblocks = glwGetInt(&b[0], 4);
+  if(!readBytes(f, b, nblocks*24)){
+    cerr << "-E- corrupted index in " << fileName << endl;
+    return false;
+  }
+  blocks.resize(nblocks);
+  for(size_t i=0; i<nblocks; i++){
+    blocks[i].t0 = glwGetInt(&b[i*24], 8);
+    blocks[i].t1 = glwGetInt(&b[i*24+8], 8);
+    blocks[i].offset = glwGetInt(&b[i*24+16], 8);
+  }
+
+  // header, everything up to the first block (or the index)
+  long headerEnd = nblocks ? (long)blocks[0].offset : indexOffset;
+  if(fseek(f, 0, SEEK_SET) || !readBytes(f, b, headerEnd) || headerEnd < 8 || memcmp(&b[0], GLW_MAGIC, 8)){
+    cerr << "-E- " << fileName << " is not a glw file." << endl;
+    return false;
+  }
+  const unsigned char *p = &b[8], *end = b.data() + b.size();
+  uint64_t len, nsig;
+  bool ok = glwGetVarint(p, end, len) && len <= (uint64_t)(end-p);
+  if(ok){
+    cellName.assign((const char*)p, len);
+    p += len;
+    ok = glwGetVarint(p, end, len) && len <= (uint64_t)(end-p);
+  }
+  if(ok){
+    timescale.assign((const char*)p, len);
+    p += len;
+    ok = glwGetVarint(p, end, nsig);
+  }
+  for(uint64_t s=0; ok && s<nsig; s++){
+    ok = glwGetVarint(p, end, len) && len <= (uint64_t)(end-p);
+    if(ok){
+      names.push_back(string((const char*)p, len));
+      p += len;
+    }
+  }
+  if(!ok){
+    cerr << "-E- corrupted header in " << fileName << endl;
+    return false;
+  }
+  return true;
+}
+
+size_t glwReader::findBlock(uint64_t t) const{
+  size_t b = 0;
+  while(b < blocks.size() && blocks[b].t1 < t) b++;
+  return b;
+}
+
+bool glwReader::readBlock(size_t b, vector<char> &snapshot, vector<change> &changes){
+  vector<unsigned char> h, comp, raw;
+  if(fseek(f, (long)blocks[b].offset, SEEK_SET) || !readBytes(f, h, 24)){
+    cerr << "-E- could not read waveform block " << b << endl;
+    return false;
+  }
+  uint64_t t0 = glwGetInt(&h[0], 8);
+  uLongf rawSize = glwGetInt(&h[16], 4);
+  size_t compSize = glwGetInt(&h[20], 4);
+  raw.resize(rawSize);
+  if(!readBytes(f, comp, compSize) ||
+     uncompress(raw.data(), &rawSize, comp.data(), compSize) != Z_OK || rawSize != raw.size()){
+    cerr << "-E- corrupted waveform block " << b << endl;
+    return false;
+  }
+
+  size_t nsig = names.size();
+  if(raw.size() < (nsig+3)/4){
+    cerr << "-E- corrupted waveform block " << b << endl;
+    return false;
+  }
+  snapshot.resize(nsig);
+  for(size_t s=0; s<nsig; s++){
+    snapshot[s] = (raw[s/4] >> (2*(s%4))) & 3;
+  }
+  changes.clear();
+  const unsigned char *p = raw.data() + (nsig+3)/4, *end = raw.data() + raw.size();
+  uint64_t sig = 0;
+  bool first = true, ok = true;
+  while(ok && p < end){
+    uint64_t dsig, count, rec;
+    ok = glwGetVarint(p, end, dsig) && glwGetVarint(p, end, count);
+    sig = first ? dsig : sig + dsig;
+    first = false;
+    ok = ok && sig < nsig;
+    uint64_t t = t0;
+    for(uint64_t c=0; ok && c<count; c++){
+      ok = glwGetVarint(p, end, rec);
+      t += rec >> 2;
+      change ch = { t, (uint32_t)sig, (char)(rec & 3) };
+      changes.push_back(ch);
+    }
+  }
+  if(!ok){
+    cerr << "-E- corrupted waveform block " << b << endl;
+    return false;
+  }
+  stable_sort(changes.begin(), changes.end());
+  return true;
+}
@@ -0,0 +1,103 @@
+#ifndef GLW_FORMAT_H
+#define GLW_FORMAT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+  glw: block based binary waveform of gl_sim.
+
+  file   = header, block*, index
+  header = "GLWAVE01", str(cell name), str(timescale), varint(nsig),
+           str(signal name)*nsig
+  block  = u64 t0, u64 t1, u32 rawSize, u32 compSize, zlib(payload)
+  index  = u32 nblocks, (u64 t0, u64 t1, u64 offset)*nblocks,
+           u64 index offset, "GLWINDEX"
+
+  payload of a block covering the times t0..t1:
+    snapshot of all signals at t0 before the block's changes, 2 bits per
+    signal (0, 1, 2 = x, 3 = z, a signal not dumped yet reads x), then the changes grouped
+    per signal in increasing signal order:
+      varint(signal - previous signal), varint(count),
+      count * varint((time - previous time) << 2 | value)
+    where the previous time of the first change is t0.
+  The index at the end of the file lets a reader seek directly to the block
+  holding a given time, the snapshot makes the block decodable on its own.
+  Integers are little endian.
+*/
+#define GLW_MAGIC       "GLWAVE01"
+#define GLW_INDEX_MAGIC "GLWINDEX"
+#define GLW_X           2
+#define GLW_Z           3
+
+static inline void glwPutVarint(std::vector<unsigned char> &b, uint64_t v){
+  while(v >= 0x80){
+    b.push_back((unsigned char)(v | 0x80));
+    v >>= 7;
+  }
+  b.push_back((unsigned char)v);
+}
+
+// returns false when the buffer ends inside the varint
+static inline bool glwGetVarint(const unsigned char *&p, const unsigned char *end, uint64_t &v){
+  v = 0;
+  for(int shift=0; p<end && shift<64; shift+=7){
+    unsigned char c = *p++;
+    v |= (uint64_t)(c & 0x7f) << shift;
+    if(!(c & 0x80)) return true;
+  }
+  return false;
+}
+
+static inline void glwPutInt(std::vector<unsigned char> &b, uint64_t v, int bytes){
+  for(int i=0; i<bytes; i++) b.push_back((unsigned char)(v >> (8*i)));
+}
+
+static inline uint64_t glwGetInt(const unsigned char *p, int bytes){
+  uint64_t v = 0;
+  for(int i=0; i<bytes; i++) v |= (uint64_t)p[i] << (8*i);
+  return v;
+}
+
+struct glwBlockIndex {
+  uint64_t t0, t1;
+  uint64_t offset;
+};
+
+/*
+  Reader of a glw file: loads the header and the block index, blocks are
+  read and decoded on demand.
+*/
+class glwReader {
+  public:
+    std::string cellName;
+    std::string timescale;            // e.g. "1ns"
+    std::vector<std::string> names;     // signal id -> name
+    std::vector<glwBlockIndex> blocks;
+
+    glwReader() : f(NULL) {}
+    ~glwReader();
+    // returns false (after printing -E-) on a missing or corrupted file
+    bool open(const std::string &fileName);
+    // first block that may hold changes at time >= t
+    size_t findBlock(uint64_t t) const;
+
+    /*
+      Decode block b into the snapshot values at its start and its changes
+      in time order (time, signal, value).
+    */
+    struct change {
+      uint64_t time;
+      uint32_t sig;
+      char val;
+      bool operator<(const change &c) const { return time < c.time || (time == c.time && sig < c.sig); }
+    };
+    bool readBlock(size_t b, std::vector<char> &snapshot, std::vector<change> &changes);
+
+  private:
+    FILE *f;
+};
+
+#endif
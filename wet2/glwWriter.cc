@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <iostream>
+#include <zlib.h>
+#include "glwWriter.h"
+
+using namespace std;
+
+glwWriter::glwWriter(const string &fileName, const simIR &ir_, const string &cellName, const string &timescale)
+  : waveWriter(ir_), name(fileName), failed(false), nsig(0), curOpen(false), done(false){
+  f = fopen(fileName.c_str(), "wb");
+  if(!f) return;
+
+  vector<unsigned char> h(GLW_MAGIC, GLW_MAGIC + 8);
+  glwPutVarint(h, cellName.size());
+  h.insert(h.end(), cellName.begin(), cellName.end());
+  glwPutVarint(h, timescale.size());
+  h.insert(h.end(), timescale.begin(), timescale.end());
+  sigs.assign(ir.numNodes, -1);
+  for(int node=0; node<ir.numNodes; node++){
+    if(!ir.isGlobal[node]) sigs[node] = nsig++;
+  }
+  glwPutVarint(h, nsig);
+  for(int node=0; node<ir.numNodes; node++){
+    if(ir.isGlobal[node]) continue;
+    glwPutVarint(h, ir.names[node].size());
+    h.insert(h.end(), ir.names[node].begin(), ir.names[node].end());
+  }
+  output(h);
+  values.assign(nsig, GLW_X);
+  writer = std::thread(&glwWriter::writerLoop, this);
+}
+
+glwWriter::~glwWriter(){
+  if(!f) return;
+  if(curOpen) closeBlock();
+  {
+    std::lock_guard<std::mutex> g(lock);
+    done = true;
+  }
+  queued.notify_one();
+  writer.join();
+
+  vector<unsigned char> b;
+  uint64_t indexOffset = ftell(f);
+  glwPutInt(b, index.size(), 4);
+  for(size_t i=0; i<index.size(); i++){
+    glwPutInt(b, index[i].t0, 8);
+    glwPutInt(b, index[i].t1, 8);
+    glwPutInt(b, index[i].offset, 8);
+  }
+  glwPutInt(b, indexOffset, 8);
+  b.insert(b.end(), GLW_INDEX_MAGIC, GLW_INDEX_MAGIC + 8);
+  output(b);
+  if(fclose(f) != 0) failed = true;
+  if(failed){
+    cerr << "-E- Could not write waveform file: " << name << endl;
+  }
+}
+
+void glwWriter::output(const vector<unsigned char> &data){
+  if(fwrite(data.data(), 1, data.size(), f) != data.size()) failed = true;
+}
+
+// a block is only closed between two time steps, so the blocks never share a time
+void glwWriter::changeTime(unsigned long long time){
+  if(curOpen && cur.changes.size() >= GLW_BLOCK_CHANGES) closeBlock();
+  if(!curOpen){
+    cur.t0 = time;
+    curOpen = true;
+  }
+  cur.t1 = time;
+}
+
+void glwWriter::writeValue(int node, char val){
+  if(!curOpen){
+    cur.t0 = cur.t1 = 0;
+    curOpen = true;
+  }
+  record r = { cur.t1, (uint32_t)sigs[node], val };
+  cur.changes.push_back(r);
+}
+
+// hand the current block to the writer thread, waits while the queue is full
+void glwWriter::closeBlock(){
+  std::unique_lock<std::mutex> g(lock);
+  taken.wait(g, [this]{ return queue.size() < GLW_QUEUE_BLOCKS; });
+  queue.push_back(block());
+  queue.back().t0 = cur.t0;
+  queue.back().t1 = cur.t1;
+  queue.back().changes.swap(cur.changes);
+  g.unlock();
+  queued.notify_one();
+  cur.changes.reserve(GLW_BLOCK_CHANGES);
+  curOpen = false;
+}
+
+void glwWriter::writerLoop(){
+  while(true){
+    std::unique_lock<std::mutex> g(lock);
+    queued.wait(g, [this]{ return done || !queue.empty(); });
+    if(queue.empty()) return;
+    block b;
+    b.t0 = queue.front().t0;
+    b.t1 = queue.front().t1;
+    b.changes.swap(queue.front().changes);
+    queue.pop_front();
+    g.unlock();
+    taken.notify_one();
+    encodeBlock(b);
+  }
+}
+
+/*
+  Encode one block (writer thread): snapshot of the values, the changes
+  grouped per signal with delta coded signals and times, zlib, write.
+*/
+void glwWriter::encodeBlock(const block &b){
+  vector<unsigned char> raw((nsig+3)/4, 0);
+  for(int s=0; s<nsig; s++){
+    raw[s/4] |= values[s] << (2*(s%4));
+  }
+
+  // changes are in time order, a stable sort by signal keeps each signal's changes in time order
+  vector<uint32_t> order(b.changes.size());
+  for(size_t i=0; i<order.size(); i++) order[i] = i;
+  stable_sort(order.begin(), order.end(),
+              [&b](uint32_t x, uint32_t y){ return b.changes[x].sig < b.changes[y].sig; });
+  uint32_t prevSig = 0;
+  for(size_t i=0; i<order.size(); ){
+    uint32_t sig = b.changes[order[i]].sig;
+    size_t j = i;
+    while(j < order.size() && b.changes[order[j]].sig == sig) j++;
+    glwPutVarint(raw, sig - prevSig);
+    glwPutVarint(raw, j - i);
+    uint64_t t = b.t0;
+    for(; i<j; i++){
+      const record &r = b.changes[order[i]];
+      glwPutVarint(raw, ((r.time - t) << 2) | r.val);
+      t = r.time;
+      values[sig] = r.val;
+    }
+    prevSig = sig;
+  }
+
+  uLongf compSize = compressBound(raw.size());
+  vector<unsigned char> out;
+  glwPutInt(out, b.t0, 8);
+  glwPutInt(out, b.t1, 8);
+  glwPutInt(out, raw.size(), 4);
+  size_t head = out.size() + 4;
+  out.resize(head + compSize);
+  compress2(&out[head], &compSize, raw.data(), raw.size(), Z_BEST_SPEED);
+  out.resize(head + compSize);
+  out[head-4] = compSize & 0xff;
+  out[head-3] = (compSize >> 8) & 0xff;
+  out[head-2] = (compSize >> 16) & 0xff;
+  out[head-1] = (compSize >> 24) & 0xff;
+
+  glwBlockIndex e = { b.t0, b.t1, (uint64_t)ftell(f) };
+  index.push_back(e);
+  output(out);
+}
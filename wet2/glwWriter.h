@@ -0,0 +1,74 @@
+#ifndef GLW_WRITER_H
+#define GLW_WRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "simIR.h"
+#include "waveWriter.h"
+#include "glwFormat.h"
+
+/*
+  Binary waveform writer (glw format, see glwFormat.h).
+  The simulation thread only appends (time, signal, value) records to the
+  current block. A full block is closed at the next time step and handed to
+  a background thread, which delta encodes it per signal, compresses it with
+  zlib and writes it, so the simulation never waits on compression or I/O
+  unless GLW_QUEUE_BLOCKS blocks are already pending.
+  A write error is remembered and reported (-E-) when the writer is deleted.
+*/
+#define GLW_BLOCK_CHANGES (1 << 16)
+#define GLW_QUEUE_BLOCKS  4
+
+class glwWriter : public waveWriter {
+  public:
+    glwWriter(const std::string &fileName, const simIR &ir, const std::string &cellName,
+              const std::string &timescale = "1ns");
+    ~glwWriter();
+    bool good() const { return f != NULL; }
+
+    void changeTime(unsigned long long time);
+
+  protected:
+    void writeValue(int node, char val);
+
+  private:
+    struct record {
+      uint64_t time;
+      uint32_t sig;
+      char val;
+    };
+    struct block {
+      uint64_t t0, t1;
+      std::vector<record> changes;
+    };
+
+    FILE *f;
+    std::string name;
+    bool failed;                      // a write failed (set by the writer thread until it is joined)
+    std::vector<int> sigs;            // node id -> signal id, -1 for global nodes
+    int nsig;
+    block cur;                        // block being filled by the simulation
+    bool curOpen;                     // cur has a start time
+
+    /* background writer */
+    std::thread writer;
+    std::mutex lock;
+    std::condition_variable queued, taken;
+    std::deque<block> queue;
+    bool done;
+    std::vector<char> values;         // signal values at the start of the next block (writer thread)
+    std::vector<glwBlockIndex> index;
+
+    void closeBlock();
+    void writerLoop();
+    void encodeBlock(const block &b);
+    void output(const std::vector<unsigned char> &data);
+};
+
+#endif
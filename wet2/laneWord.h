@@ -0,0 +1,66 @@
+#ifndef LANE_WORD_H
+#define LANE_WORD_H
+
+#include <stdint.h>
+
+/*
+  W machine words used as 64*W independent one-bit simulation lanes.
+  All operators work lane-wise with plain loops over the W words, which the
+  compiler turns into AVX2 (W=4) / AVX-512 (W=8) instructions when the target
+  allows it (build with ARCH=-mavx2 or ARCH=-mavx512f).
+*/
+template<int W>
+struct laneWord {
+  uint64_t w[W];
+
+  static laneWord zero(){
+    laneWord r;
+    for(int i=0;i<W;i++) r.w[i]=0;
+    return r;
+  }
+  static laneWord ones(){
+    laneWord r;
+    for(int i=0;i<W;i++) r.w[i]=~(uint64_t)0;
+    return r;
+  }
+
+  laneWord operator&(const laneWord &o) const{
+    laneWord r;
+    for(int i=0;i<W;i++) r.w[i]=w[i]&o.w[i];
+    return r;
+  }
+  laneWord operator|(const laneWord &o) const{
+    laneWord r;
+    for(int i=0;i<W;i++) r.w[i]=w[i]|o.w[i];
+    return r;
+  }
+  laneWord operator^(const laneWord &o) const{
+    laneWord r;
+    for(int i=0;i<W;i++) r.w[i]=w[i]^o.w[i];
+    return r;
+  }
+  laneWord operator~() const{
+    laneWord r;
+    for(int i=0;i<W;i++) r.w[i]=~w[i];
+    return r;
+  }
+  bool operator==(const laneWord &o) const{
+    uint64_t d=0;
+    for(int i=0;i<W;i++) d|=w[i]^o.w[i];
+    return d==0;
+  }
+  bool operator!=(const laneWord &o) const{
+    return !(*this==o);
+  }
+
+  bool lane(int l) const{
+    return (w[l>>6]>>(l&63))&1;
+  }
+  void setLane(int l,bool v){
+    uint64_t m=(uint64_t)1<<(l&63);
+    if(v) w[l>>6]|=m;
+    else w[l>>6]&=~m;
+  }
+};
+
+#endif
@@ -0,0 +1,249 @@
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+#include <ctype.h>
+#include "monitor.h"
+
+using namespace std;
+
+#define MON_MAX_REPORTS 10            // failures printed per monitor
+
+static bool nameChar(char c){
+  return isalnum((unsigned char)c) || c=='_' || c=='/' || c=='[' || c==']' || c=='.' || c=='$';
+}
+
+// split a monitor line into names / numbers and operators, false on an unknown character
+static bool tokenize(const string &l, vector<string> &toks, string &err){
+  toks.clear();
+  for(size_t c=0; c<l.size(); ){
+    if(isspace((unsigned char)l[c])){
+      c++;
+    } else if(nameChar(l[c])){
+      size_t e=c;
+      while(e<l.size() && nameChar(l[e])) e++;
+      toks.push_back(l.substr(c, e-c));
+      c=e;
+    } else if((l[c]=='=' || l[c]=='!') && c+1<l.size() && l[c+1]=='='){
+      toks.push_back(l.substr(c, 2));
+      c+=2;
+    } else if(string("()&|^~!:").find(l[c])!=string::npos){
+      toks.push_back(string(1, l[c]));
+      c++;
+    } else {
+      err=string("unexpected character '")+l[c]+"'";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool monitorSet::load(const string &fileName, const simIR &ir_){
+  ir=&ir_;
+  ifstream f(fileName.c_str());
+  if(!f.good()){
+    cerr << "-E- Could not open monitor file: " << fileName << endl;
+    return false;
+  }
+  string l;
+  int lineNum=0;
+  size_t maxCode=0;
+  while(getline(f, l)){
+    lineNum++;
+    size_t c=l.find('#');
+    if(c!=string::npos) l.erase(c);
+    if(!tokenize(l, toks, err)){
+      cerr << "-E- " << fileName << ":" << lineNum << ": " << err << endl;
+      return false;
+    }
+    if(toks.empty()) continue;
+    monitor m;
+    tok=0;
+    if(toks.size()>1 && toks[1]==":"){
+      m.label=toks[0];
+      tok=2;
+    } else {
+      m.label=fileName+":"+to_string(lineNum);
+    }
+    size_t first=l.find_first_not_of(" \t", tok ? l.find(':')+1 : 0);
+    m.text=l.substr(first, l.find_last_not_of(" \t\r")+1-first);
+    m.never=false;
+    if(tok<toks.size() && (toks[tok]=="never" || toks[tok]=="always")){
+      m.never=toks[tok]=="never";
+      tok++;
+    }
+    m.fails=0;
+    err.clear();
+    if(!parseEq(m, m.warmup) || tok<toks.size()){
+      if(err.empty()) err="unexpected '"+toks[tok]+"'";
+      cerr << "-E- " << fileName << ":" << lineNum << ": " << err << endl;
+      return false;
+    }
+    if(m.code.size()>maxCode) maxCode=m.code.size();
+    mons.push_back(m);
+  }
+  stack.resize(maxCode);
+  return true;
+}
+
+// eq := or (('=='|'!=') or)?
+bool monitorSet::parseEq(monitor &m, unsigned long long &lag){
+  if(!parseBinary(m, 0, lag)) return false;
+  if(tok<toks.size() && (toks[tok]=="==" || toks[tok]=="!=")){
+    opCode code=toks[tok]=="==" ? OP_EQ : OP_NE;
+    unsigned long long rlag;
+    tok++;
+    if(!parseBinary(m, 0, rlag)) return false;
+    if(rlag>lag) lag=rlag;
+    op o={code, 0};
+    m.code.push_back(o);
+  }
+  return true;
+}
+
+// level 0: '|', 1: '^', 2: '&'
+bool monitorSet::parseBinary(monitor &m, int level, unsigned long long &lag){
+  static const char *ops[3]={"|", "^", "&"};
+  static const opCode codes[3]={OP_OR, OP_XOR, OP_AND};
+  if(!(level<2 ? parseBinary(m, level+1, lag) : parseUnary(m, lag))) return false;
+  while(tok<toks.size() && toks[tok]==ops[level]){
+    unsigned long long rlag;
+    tok++;
+    if(!(level<2 ? parseBinary(m, level+1, rlag) : parseUnary(m, rlag))) return false;
+    if(rlag>lag) lag=rlag;
+    op o={codes[level], 0};
+    m.code.push_back(o);
+  }
+  return true;
+}
+
+// unary := ('~'|'!') unary | primary ('after' N ['cycles'])*
+bool monitorSet::parseUnary(monitor &m, unsigned long long &lag){
+  if(tok<toks.size() && (toks[tok]=="~" || toks[tok]=="!")){
+    tok++;
+    if(!parseUnary(m, lag)) return false;
+    op o={OP_NOT, 0};
+    m.code.push_back(o);
+    return true;
+  }
+  if(!parsePrimary(m, lag)) return false;
+  while(tok<toks.size() && toks[tok]=="after"){
+    tok++;
+    char *end=NULL;
+    long n=tok<toks.size() ? strtol(toks[tok].c_str(), &end, 10) : 0;
+    if(!end || *end || n<1){
+      err="'after' needs a number of cycles";
+      return false;
+    }
+    tok++;
+    if(tok<toks.size() && (toks[tok]=="cycles" || toks[tok]=="cycle")) tok++;
+    delayLine d={history.size(), (size_t)n, 0};
+    history.resize(history.size()+n, 0);
+    op o={OP_DELAY, (int)delays.size()};
+    delays.push_back(d);
+    m.code.push_back(o);
+    lag+=n;
+  }
+  return true;
+}
+
+// primary := name | 0 | 1 | '(' eq ')'
+bool monitorSet::parsePrimary(monitor &m, unsigned long long &lag){
+  lag=0;
+  if(tok>=toks.size()){
+    err="unexpected end of the expression";
+    return false;
+  }
+  const string &t=toks[tok++];
+  if(t=="("){
+    if(!parseEq(m, lag)) return false;
+    if(tok>=toks.size() || toks[tok]!=")"){
+      err="missing ')'";
+      return false;
+    }
+    tok++;
+    return true;
+  }
+  if(t=="0" || t=="1"){
+    op o={OP_CONST, t[0]-'0'};
+    m.code.push_back(o);
+    return true;
+  }
+  if(!nameChar(t[0])){
+    err="unexpected '"+t+"'";
+    return false;
+  }
+  int node=ir->nodeId(t);
+  if(node<0){
+    err="unknown node "+t;
+    return false;
+  }
+  op o={OP_NODE, node};
+  m.code.push_back(o);
+  for(size_t n=0; n<m.nodes.size(); n++){
+    if(m.nodes[n]==node) return true;
+  }
+  m.nodes.push_back(node);
+  return true;
+}
+
+// a node of the monitor is X/Z (-4state), its check is skipped
+bool monitorSet::unknown(const simState &st, const monitor &m) const{
+  if(st.unk.empty()) return false;
+  for(size_t n=0; n<m.nodes.size(); n++){
+    if(st.unk[m.nodes[n]]) return true;
+  }
+  return false;
+}
+
+bool monitorSet::check(const simState &st, unsigned long long time){
+  bool run=true;
+  for(size_t i=0; i<mons.size(); i++){
+    monitor &m=mons[i];
+    size_t sp=0;
+    for(size_t c=0; c<m.code.size(); c++){
+      const op &o=m.code[c];
+      switch(o.code){
+        case OP_NODE:  stack[sp++]=st.val[o.arg] & 1; break;
+        case OP_CONST: stack[sp++]=o.arg; break;
+        case OP_NOT:   stack[sp-1]^=1; break;
+        case OP_AND:   sp--; stack[sp-1]&=stack[sp]; break;
+        case OP_OR:    sp--; stack[sp-1]|=stack[sp]; break;
+        case OP_XOR:   sp--; stack[sp-1]^=stack[sp]; break;
+        case OP_EQ:    sp--; stack[sp-1]=stack[sp-1]==stack[sp]; break;
+        case OP_NE:    sp--; stack[sp-1]=stack[sp-1]!=stack[sp]; break;
+        case OP_DELAY: {
+          delayLine &d=delays[o.arg];
+          char v=history[d.start+d.pos];
+          history[d.start+d.pos]=stack[sp-1];
+          stack[sp-1]=v;
+          if(++d.pos==d.len) d.pos=0;
+          break;
+        }
+      }
+    }
+    if(m.warmup){
+      m.warmup--;
+      continue;
+    }
+    if(stack[0]!=(char)m.never || unknown(st, m)) continue;
+    failures++;
+    if(m.fails++<MON_MAX_REPORTS){
+      cerr << "-E- time " << time << " monitor " << m.label << " failed: " << m.text << " (";
+      for(size_t n=0; n<m.nodes.size(); n++){
+        cerr << (n ? " " : "") << ir->names[m.nodes[n]] << "=" << "01xz"[(int)st.value(m.nodes[n])];
+      }
+      cerr << ")" << endl;
+    }
+    if(stopOnFail) run=false;
+  }
+  return run;
+}
+
+void monitorSet::summary() const{
+  for(size_t i=0; i<mons.size(); i++){
+    if(mons[i].fails){
+      cout << "-I- monitor " << mons[i].label << ": " << mons[i].fails << " failures" << endl;
+    }
+  }
+  cout << "-I- Monitors: " << mons.size() << " monitors, " << failures << " failures" << endl;
+}
@@ -0,0 +1,76 @@
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#include <string>
+#include <vector>
+#include "simIR.h"
+
+/*
+  Cycle level monitors (-monitors file).
+  Each monitor is compiled once into postfix code over node ids and
+  evaluated on the node values after every vector, so regressions can
+  check properties without dumping and diffing waveforms.
+
+  Monitor file, one monitor per line, '#' starts a comment:
+    [label:] [never|always] expr
+  `never` fails when expr is 1, `always` (the default) when it is 0.
+  expr is made of node names, 0, 1, parentheses and, from the loosest:
+    == !=        equality of two values
+    |  ^  &      or, xor, and
+    ~  !         not
+    e after N [cycles]   the value e had N vectors before
+  e.g.  "never (A & B)"   "Y == X after 2 cycles".
+  A monitor with delays is checked once its history is filled. With -4state
+  a failure is not reported while a node of the monitor is X or Z.
+*/
+class monitorSet {
+  public:
+    bool stopOnFail;                  // check() asks to stop at the first failure
+    unsigned long failures;           // failed checks, all monitors
+
+    monitorSet() : stopOnFail(false), failures(0) {}
+    // returns false (after printing -E-) on a bad monitor file or an unknown node
+    bool load(const std::string &fileName, const simIR &ir);
+    bool empty() const { return mons.empty(); }
+    // evaluate every monitor on the values after vector time, reports failures.
+    // returns false when a monitor failed and stopOnFail is set.
+    bool check(const simState &st, unsigned long long time);
+    // prints the failures of every monitor
+    void summary() const;
+
+  private:
+    enum opCode { OP_NODE, OP_CONST, OP_NOT, OP_AND, OP_OR, OP_XOR, OP_EQ, OP_NE, OP_DELAY };
+    struct op {
+      opCode code;
+      int arg;                        // node id, constant, or delay line index
+    };
+    struct delayLine {
+      size_t start, len, pos;         // ring of len values in history[start..]
+    };
+    struct monitor {
+      std::string label;              // label or file:line
+      std::string text;
+      bool never;
+      std::vector<op> code;
+      std::vector<int> nodes;         // nodes of the expression, for the failure report
+      unsigned long long warmup;      // vectors before the delays hold real history
+      unsigned long fails;
+    };
+    const simIR *ir;
+    std::vector<monitor> mons;
+    std::vector<delayLine> delays;
+    std::vector<char> history;
+    std::vector<char> stack;
+
+    // recursive descent compiler, tokens of the current line
+    std::vector<std::string> toks;
+    size_t tok;
+    std::string err;
+    bool parseEq(monitor &m, unsigned long long &lag);
+    bool parseBinary(monitor &m, int level, unsigned long long &lag);
+    bool parseUnary(monitor &m, unsigned long long &lag);
+    bool parsePrimary(monitor &m, unsigned long long &lag);
+    bool unknown(const simState &st, const monitor &m) const;
+};
+
+#endif
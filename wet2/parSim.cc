@@ -0,0 +1,215 @@
+#include <iostream>
+#include <chrono>
+#include "parSim.h"
+
+using namespace std;
+
+parallelSim::parallelSim(const simIR &ir_, int threads)
+  : ir(ir_), nthreads(threads<1 ? 1 : threads), ncut(0), nlevels(0),
+    cursors(nthreads), arrived(0), generation(0), sleepers(0), phase(0), cur(0), stop(false){
+  partition();
+  for(int t=1; t<nthreads; t++){
+    workers.push_back(std::thread(&parallelSim::worker, this, t));
+  }
+}
+
+parallelSim::~parallelSim(){
+  stop=true;
+  barrier();   // release the workers waiting for the next vector
+  for(size_t w=0; w<workers.size(); w++){
+    workers[w].join();
+  }
+}
+
+/*
+  Greedy clustering in topological order. cap is the balanced share of a
+  cluster plus 5%, the cut nets are counted once per (net, reading cluster).
+*/
+void parallelSim::partition(){
+  int T=nthreads;
+  cluster.assign(ir.numInsts, 0);
+  vector<int> load(T, 0);
+  int cap=(ir.numInsts*105/100)/T+1;
+  vector<int> votes(T, 0);
+  for(size_t o=0; o<ir.order.size(); o++){
+    int inst=ir.order[o];
+    for(int k=ir.faninStart[inst]; k<ir.faninStart[inst+1]; k++){
+      int d=ir.driver[ir.fanin[k]];
+      if(d>=0) votes[cluster[d]]++;
+    }
+    int best=-1;
+    for(int c=0; c<T; c++){
+      if(load[c]>=cap) continue;
+      if(best<0 || votes[c]>votes[best] || (votes[c]==votes[best] && load[c]<load[best])) best=c;
+    }
+    if(best<0) best=0;
+    for(int c=0; c<T; c++) votes[c]=0;
+    cluster[inst]=best;
+    load[best]++;
+  }
+
+  ncut=0;
+  vector<int> seen(T, -1);
+  for(int n=0; n<ir.numNodes; n++){
+    int d=ir.driver[n];
+    if(d<0) continue;
+    for(int k=ir.fanoutStart[n]; k<ir.fanoutStart[n+1]; k++){
+      int c=cluster[ir.fanout[k]];
+      if(c!=cluster[d] && seen[c]!=n){
+        seen[c]=n;
+        ncut++;
+      }
+    }
+  }
+
+  // tasks: per level, per cluster, chunks of at most PAR_TASK instances
+  nlevels=ir.levelStart.size()-1;
+  porder.clear();
+  tasks.clear();
+  queueStart.clear();
+  for(int l=0; l<nlevels; l++){
+    for(int c=0; c<T; c++){
+      queueStart.push_back(tasks.size());
+      int first=porder.size();
+      for(int o=ir.levelStart[l]; o<ir.levelStart[l+1]; o++){
+        if(cluster[ir.order[o]]==c) porder.push_back(ir.order[o]);
+      }
+      for(int a=first; a<(int)porder.size(); a+=PAR_TASK){
+        task tk;
+        tk.first=a;
+        tk.last=min(a+PAR_TASK, (int)porder.size());
+        tasks.push_back(tk);
+      }
+    }
+  }
+  queueStart.push_back(tasks.size());
+
+  dffs.clear();
+  for(int i=0; i<ir.numInsts; i++){
+    if(ir.type[i]==CELL_DFF) dffs.push_back(i);
+  }
+}
+
+/*
+  Sense counting barrier: the last thread to arrive advances the phase,
+  resets the task cursors of the next level and releases the others.
+  A waiting thread spins for the short waits between two levels, after
+  PAR_SPIN rounds (a worker idle between vectors) it sleeps on the condition
+  variable until the release. The release wakes the sleepers only when
+  there are any, the generation and the sleeper count are both seq_cst so
+  either the sleeper sees the new generation or the releaser sees it.
+*/
+void parallelSim::barrier(){
+  int gen=generation.load(std::memory_order_acquire);
+  if(arrived.fetch_add(1, std::memory_order_acq_rel)==nthreads-1){
+    arrived.store(0, std::memory_order_relaxed);
+    phase++;
+    if(phase<nlevels){
+      for(int t=0; t<nthreads; t++){
+        cursors[t].next.store(queueStart[phase*nthreads+t], std::memory_order_relaxed);
+      }
+    }
+    generation.fetch_add(1);
+    if(sleepers.load()>0){
+      std::lock_guard<std::mutex> l(sleepLock);
+      wake.notify_all();
+    }
+  } else {
+    int spins=0;
+    while(generation.load(std::memory_order_acquire)==gen){
+      if(++spins<PAR_SPIN){
+        if(spins>1000) std::this_thread::yield();
+        continue;
+      }
+      sleepers.fetch_add(1);
+      {
+        std::unique_lock<std::mutex> l(sleepLock);
+        while(generation.load()==gen) wake.wait(l);
+      }
+      sleepers.fetch_sub(1);
+    }
+  }
+}
+
+void parallelSim::worker(int t){
+  while(true){
+    barrier();            // wait for a vector (or the stop request)
+    if(stop) return;
+    runVector(t);
+  }
+}
+
+// run the tasks of one level: own queue first, then steal from the others
+void parallelSim::runLevel(int t, int level){
+  for(int v=0; v<nthreads; v++){
+    int q=(t+v)%nthreads;
+    int end=queueStart[level*nthreads+q+1];
+    while(true){
+      int k=cursors[q].next.fetch_add(1, std::memory_order_relaxed);
+      if(k>=end) break;
+      simState &st=*cur;
+      for(int o=tasks[k].first; o<tasks[k].last; o++){
+        int inst=porder[o];
+        if(ir.type[inst]==CELL_DFF){
+          if(dffEdge(ir, st, inst)) st.val[ir.out[inst]]=st.dffState[inst];
+        } else {
+          st.val[ir.out[inst]]=evalGate(ir, &st.val[0], inst);
+        }
+      }
+    }
+  }
+}
+
+void parallelSim::runVector(int t){
+  for(int l=0; l<nlevels; l++){
+    runLevel(t, l);
+    barrier();
+  }
+  // dffs without an edge sample their settled D input, static split over the threads
+  simState &st=*cur;
+  size_t chunk=(dffs.size()+nthreads-1)/nthreads;
+  for(size_t k=t*chunk; k<dffs.size() && k<(t+1)*chunk; k++){
+    int inst=dffs[k];
+    if(!dffEdge(ir, st, inst)){
+      st.dffState[inst]=st.val[ir.fanin[ir.faninStart[inst]]];
+    }
+  }
+  barrier();
+}
+
+void parallelSim::simulate(simState &st, vector<int> &sigNodes, vector<char> &sigVals){
+  saveClocks(ir, st.val, st.prevVal);
+  for(size_t s=0; s<sigNodes.size(); s++){
+    st.val[sigNodes[s]]=sigVals[s];
+  }
+  cur=&st;
+  // the start barrier moves the phase from -1 to level 0 and sets its cursors
+  phase=-1;
+  barrier();
+  runVector(0);
+}
+
+void benchParallel(const simIR &ir, vector<int> &sigNodes, vector<char> &rows, int maxThreads){
+  size_t nsigs=sigNodes.size();
+  size_t nrows=nsigs ? rows.size()/nsigs : 0;
+  double base=0;
+  cout << "-I- Benchmark: " << ir.numInsts << " instances, " << ir.levelStart.size()-1
+       << " levels, " << nrows << " vectors" << endl;
+  cout << "threads  cut-nets  seconds  vectors/sec  speedup" << endl;
+  // 1, 2, 4 .. threads, always ending with maxThreads
+  for(int T=1; T<=maxThreads; T=(T<maxThreads && T*2>maxThreads) ? maxThreads : T*2){
+    parallelSim sim(ir, T);
+    simState st;
+    st.init(ir);
+    vector<char> sigVals(nsigs);
+    chrono::steady_clock::time_point start=chrono::steady_clock::now();
+    for(size_t r=0; r<nrows; r++){
+      for(size_t s=0; s<nsigs; s++) sigVals[s]=rows[r*nsigs+s];
+      sim.simulate(st, sigNodes, sigVals);
+    }
+    double sec=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+    if(T==1) base=sec;
+    printf("%7d  %8d  %7.3f  %11.0f  %7.2f\n", T, sim.cutNets(), sec,
+           sec>0 ? nrows/sec : 0.0, sec>0 ? base/sec : 0.0);
+  }
+}
@@ -0,0 +1,76 @@
+#ifndef PAR_SIM_H
+#define PAR_SIM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "simIR.h"
+
+/*
+  Multi-threaded levelized simulation.
+  The instances are partitioned into one cluster per thread (greedy in
+  topological order: an instance joins the cluster driving most of its
+  inputs while that cluster is under its share, so few nets are cut).
+  Every level is cut into tasks of at most PAR_TASK instances of one cluster
+  and queued on the thread owning the cluster; a thread which emptied its
+  queue steals tasks from the other queues. Threads meet at a barrier after
+  every level, which is where values of cut nets become visible to the
+  readers in other clusters.
+*/
+#define PAR_TASK 256
+// barrier rounds a thread spins (yielding after 1000) before it sleeps
+#define PAR_SPIN 10000
+
+class parallelSim {
+  public:
+    parallelSim(const simIR &ir, int threads);
+    ~parallelSim();
+
+    // apply the signal values and simulate one vector (same semantics as Cycle_Simulate)
+    void simulate(simState &st, std::vector<int> &sigNodes, std::vector<char> &sigVals);
+
+    int numThreads() const { return nthreads; }
+    int cutNets() const { return ncut; }
+
+  private:
+    struct task { int first, last; };  // range in porder
+
+    const simIR &ir;
+    int nthreads;
+    int ncut;
+    std::vector<int> cluster;          // instance id -> cluster (= owning thread)
+    std::vector<int> porder;           // instances sorted by level, then cluster
+    std::vector<task> tasks;
+    std::vector<int> queueStart;       // tasks of thread t in level l: [queueStart[l*T+t], queueStart[l*T+t+1])
+    int nlevels;
+    std::vector<int> dffs;             // dff instances, sampled after the last level
+
+    // per thread task cursor of the current level, padded against false sharing
+    struct cursor { std::atomic<int> next; char pad[64-sizeof(std::atomic<int>)]; };
+    std::vector<cursor> cursors;
+
+    // phase barrier
+    std::atomic<int> arrived;
+    std::atomic<int> generation;
+    std::atomic<int> sleepers;         // threads asleep in the barrier
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    int phase;                         // current level, nlevels = dff sampling
+
+    simState *cur;                     // state of the vector being simulated
+    bool stop;
+    std::vector<std::thread> workers;
+
+    void partition();
+    void worker(int t);
+    void runVector(int t);
+    void runLevel(int t, int level);
+    void barrier();
+};
+
+// simulate rows (one char per signal) with 1,2,4.. maxThreads threads and report the speedup
+void benchParallel(const simIR &ir, std::vector<int> &sigNodes, std::vector<char> &rows, int maxThreads);
+
+#endif
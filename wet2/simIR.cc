@@ -0,0 +1,357 @@
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "simIR.h"
+
+using namespace std;
+
+int simIR::nodeId(hcmNode *node) const{
+  std::vector<std::pair<hcmNode*, int> >::const_iterator I =
+    lower_bound(nodeIndex.begin(), nodeIndex.end(), std::make_pair(node, -1));
+  if(I==nodeIndex.end() || I->first!=node) return -1;
+  return I->second;
+}
+
+int simIR::nodeId(const string &name) const{
+  std::vector<string>::const_iterator I = lower_bound(names.begin(), names.end(), name);
+  if(I==names.end() || *I!=name) return -1;
+  return I - names.begin();
+}
+
+/*
+  Steps 3 and 4 of the compile, shared by buildSimIR and sliceSimIR: node
+  fanout, node drivers and clock domains from the instance fanin.
+*/
+static void connectSimIR(simIR &ir, const vector<int> &fanoutCount){
+  // fanout CSR: prefix sum of the counts, then fill
+  ir.fanoutStart.assign(ir.numNodes+1, 0);
+  for(int n=0; n<ir.numNodes; n++){
+    ir.fanoutStart[n+1]=ir.fanoutStart[n]+fanoutCount[n];
+  }
+  ir.fanout.assign(ir.fanoutStart[ir.numNodes], 0);
+  vector<int> fill(ir.fanoutStart.begin(), ir.fanoutStart.end()-1);
+  for(int i=0; i<ir.numInsts; i++){
+    for(int k=ir.faninStart[i]; k<ir.faninStart[i+1]; k++){
+      ir.fanout[fill[ir.fanin[k]]++]=i;
+    }
+  }
+
+  ir.driver.assign(ir.numNodes, -1);
+  for(int i=0; i<ir.numInsts; i++){
+    ir.driver[ir.out[i]]=i;
+  }
+
+  // clock domains: one per distinct CLK pin node, dffs grouped per domain in CSR form
+  ir.clocks.clear();
+  ir.clockDomain.assign(ir.numNodes, -1);
+  vector<int> domainCount;
+  for(int i=0; i<ir.numInsts; i++){
+    if(ir.type[i]!=CELL_DFF) continue;
+    int clk_node=ir.fanin[ir.faninStart[i]+1];
+    if(ir.clockDomain[clk_node]<0){
+      ir.clockDomain[clk_node]=ir.clocks.size();
+      ir.clocks.push_back(clk_node);
+      domainCount.push_back(0);
+    }
+    domainCount[ir.clockDomain[clk_node]]++;
+  }
+  ir.domainStart.assign(ir.clocks.size()+1, 0);
+  for(size_t d=0; d<ir.clocks.size(); d++){
+    ir.domainStart[d+1]=ir.domainStart[d]+domainCount[d];
+  }
+  ir.domainDffs.assign(ir.domainStart[ir.clocks.size()], 0);
+  vector<int> dfill(ir.domainStart.begin(), ir.domainStart.end()-1);
+  for(int i=0; i<ir.numInsts; i++){
+    if(ir.type[i]==CELL_DFF){
+      ir.domainDffs[dfill[ir.clockDomain[ir.fanin[ir.faninStart[i]+1]]]++]=i;
+    }
+  }
+
+  // clock stages: the domains of the dffs in the combinational cone of each clock,
+  // then the longest chain over them (Kahn's algorithm, domains on a loop stay at 0)
+  int nd=ir.clocks.size();
+  vector< vector<int> > users(nd);    // domain -> domains whose clock it drives
+  vector<int> indeg(nd, 0), seen(ir.numNodes, -1), seenDomain(nd, -1), work;
+  for(int d=0; d<nd; d++){
+    work.push_back(ir.clocks[d]);
+    seen[ir.clocks[d]]=d;
+    while(!work.empty()){
+      int i=ir.driver[work.back()];
+      work.pop_back();
+      if(i<0) continue;
+      if(ir.type[i]==CELL_DFF){
+        int e=ir.clockDomain[ir.fanin[ir.faninStart[i]+1]];
+        if(seenDomain[e]!=d){
+          seenDomain[e]=d;
+          users[e].push_back(d);
+          indeg[d]++;
+        }
+        continue;
+      }
+      for(int k=ir.faninStart[i]; k<ir.faninStart[i+1]; k++){
+        if(seen[ir.fanin[k]]!=d){
+          seen[ir.fanin[k]]=d;
+          work.push_back(ir.fanin[k]);
+        }
+      }
+    }
+  }
+  ir.clockStage.assign(nd, 0);
+  for(int d=0; d<nd; d++){
+    if(indeg[d]==0) work.push_back(d);
+  }
+  while(!work.empty()){
+    int e=work.back();
+    work.pop_back();
+    for(size_t u=0; u<users[e].size(); u++){
+      int d=users[e][u];
+      ir.clockStage[d]=max(ir.clockStage[d], ir.clockStage[e]+1);
+      if(--indeg[d]==0) work.push_back(d);
+    }
+  }
+}
+
+/*
+  One time compile step of the flat cell:
+  1. number the nodes in the order of the (sorted) node map.
+  2. number the instances, look up their master cell in the cell library and
+     collect the input/output node ids in pin order. for a dff the inputs are
+     stored as {D, CLK}.
+  3. build the node fanout (instances reading the node) in CSR form by counting first.
+  4. find the clock domains: every node on a dff CLK pin, with the dffs it clocks,
+     and their clock stages (how many dffs a divided clock comes through).
+*/
+bool buildSimIR(hcmCell *flatCell, set<string> &globalNodes, cellLibrary &lib, simIR &ir){
+  std::map< std::string, hcmNode* >::const_iterator nI;
+  ir.numNodes = flatCell->getNodes().size();
+  ir.nodes.clear();
+  ir.names.clear();
+  ir.isGlobal.assign(ir.numNodes, 0);
+  ir.nodeIndex.clear();
+  ir.vddNode = ir.vssNode = -1;
+  for (nI =flatCell->getNodes().begin(); nI != flatCell->getNodes().end(); nI++){
+    hcmNode *node= nI->second;
+    int id = ir.nodes.size();
+    ir.nodes.push_back(node);
+    ir.names.push_back(node->getName());
+    ir.nodeIndex.push_back(std::make_pair(node, id));
+    if(globalNodes.find(node->getName()) != globalNodes.end()){
+      ir.isGlobal[id]=1;
+    }
+    if(node->getName()=="VDD") ir.vddNode=id;
+    if(node->getName()=="VSS") ir.vssNode=id;
+  }
+  sort(ir.nodeIndex.begin(), ir.nodeIndex.end());
+
+  std::map< std::string, hcmInstance* >::const_iterator iI;
+  ir.numInsts = flatCell->getInstances().size();
+  ir.insts.clear();
+  ir.type.clear();
+  ir.cells.clear();
+  ir.out.clear();
+  ir.fanin.clear();
+  ir.faninStart.clear();
+  ir.faninStart.push_back(0);
+  vector<int> fanoutCount(ir.numNodes, 0);
+  vector<hcmNode*> pins;
+  for (iI =flatCell->getInstances().begin(); iI != flatCell->getInstances().end(); iI++){
+    hcmInstance *inst= iI->second;
+    const cellDesc *desc = lib.lookup(inst->masterCell());
+    if(!desc){
+      return false;
+    }
+    cellLibrary::pinNodes(*desc, inst, pins);
+    // inputs in pin order, a dff gets its CLK appended
+    vector<int> ins(desc->inputs);
+    if(desc->clock>=0) ins.push_back(desc->clock);
+    for(size_t k=0; k<ins.size(); k++){
+      if(!pins[ins[k]]){
+        cerr << "-E- input " << desc->pins[ins[k]] << " of instance " << inst->getName() << " is not connected, aborting." << endl;
+        return false;
+      }
+      int id = ir.nodeId(pins[ins[k]]);
+      ir.fanin.push_back(id);
+      fanoutCount[id]++;
+    }
+    if(!pins[desc->output]){
+      cerr << "-E- instance " << inst->getName() << " has no output, aborting." << endl;
+      return false;
+    }
+    ir.insts.push_back(inst);
+    ir.type.push_back((char)desc->type);
+    ir.cells.push_back(desc);
+    ir.out.push_back(ir.nodeId(pins[desc->output]));
+    ir.faninStart.push_back(ir.fanin.size());
+  }
+
+  connectSimIR(ir, fanoutCount);
+  return true;
+}
+
+/*
+  Cone of influence of the observed nodes: walking back from them through the
+  drivers, a dff brings in both its D and CLK cones so the registers feeding
+  the observed logic are simulated too. The sliced ir keeps the cone plus the
+  undriven nodes (inputs, VDD/VSS) so the signals file still binds, and keeps
+  the relative order of the nodes so names stays sorted.
+  Observed file: whitespace separated node names, '#' starts a comment.
+*/
+bool sliceSimIR(const simIR &full, const string &observeFile, simIR &cone){
+  ifstream f(observeFile.c_str());
+  if(!f.good()){
+    cerr << "-E- Could not open observed nodes file: " << observeFile << endl;
+    return false;
+  }
+  vector<char> keepNode(full.numNodes, 0);
+  vector<char> keepInst(full.numInsts, 0);
+  vector<int> work;
+  string l, name;
+  while(getline(f, l)){
+    size_t c = l.find('#');
+    if(c != string::npos) l.erase(c);
+    istringstream ls(l);
+    while(ls >> name){
+      int id = full.nodeId(name);
+      if(id<0){
+        cerr << "-E- observed node " << name << " is not a node of the top cell, aborting." << endl;
+        return false;
+      }
+      if(!keepNode[id]){
+        keepNode[id]=1;
+        work.push_back(id);
+      }
+    }
+  }
+  if(work.empty()){
+    cerr << "-E- no observed nodes in " << observeFile << endl;
+    return false;
+  }
+  while(!work.empty()){
+    int n=work.back();
+    work.pop_back();
+    int d=full.driver[n];
+    if(d<0 || keepInst[d]) continue;
+    keepInst[d]=1;
+    for(int k=full.faninStart[d]; k<full.faninStart[d+1]; k++){
+      if(!keepNode[full.fanin[k]]){
+        keepNode[full.fanin[k]]=1;
+        work.push_back(full.fanin[k]);
+      }
+    }
+  }
+
+  // renumber the kept nodes in their original order
+  vector<int> newId(full.numNodes, -1);
+  cone.nodes.clear();
+  cone.names.clear();
+  cone.isGlobal.clear();
+  cone.nodeIndex.clear();
+  cone.vddNode = cone.vssNode = -1;
+  for(int n=0; n<full.numNodes; n++){
+    if(!keepNode[n] && full.driver[n]>=0) continue;
+    int id = cone.nodes.size();
+    newId[n]=id;
+    cone.nodes.push_back(full.nodes[n]);
+    cone.names.push_back(full.names[n]);
+    cone.isGlobal.push_back(full.isGlobal[n]);
+    cone.nodeIndex.push_back(std::make_pair(full.nodes[n], id));
+    if(n==full.vddNode) cone.vddNode=id;
+    if(n==full.vssNode) cone.vssNode=id;
+  }
+  cone.numNodes = cone.nodes.size();
+  sort(cone.nodeIndex.begin(), cone.nodeIndex.end());
+
+  cone.insts.clear();
+  cone.type.clear();
+  cone.cells.clear();
+  cone.out.clear();
+  cone.fanin.clear();
+  cone.faninStart.clear();
+  cone.faninStart.push_back(0);
+  vector<int> fanoutCount(cone.numNodes, 0);
+  for(int i=0; i<full.numInsts; i++){
+    if(!keepInst[i]) continue;
+    for(int k=full.faninStart[i]; k<full.faninStart[i+1]; k++){
+      int id = newId[full.fanin[k]];
+      cone.fanin.push_back(id);
+      fanoutCount[id]++;
+    }
+    cone.insts.push_back(full.insts[i]);
+    cone.type.push_back(full.type[i]);
+    cone.cells.push_back(full.cells[i]);
+    cone.out.push_back(newId[full.out[i]]);
+    cone.faninStart.push_back(cone.fanin.size());
+  }
+  cone.numInsts = cone.insts.size();
+  connectSimIR(cone, fanoutCount);
+  cone.order.clear();
+  cone.levelStart.clear();
+  return true;
+}
+
+void simState::init(const simIR &ir){
+  val.assign(ir.numNodes, 0);
+  unk.clear();
+  prevVal.assign(ir.numNodes, 0);
+  dffState.assign(ir.numInsts, 0);
+  fired.assign(ir.clocks.size(), 0);
+  changed.clear();
+  isChanged.assign(ir.numNodes, 0);
+  if(ir.vddNode>=0){
+    val[ir.vddNode]=1;
+    prevVal[ir.vddNode]=1;
+  }
+}
+
+// true if instance reader depends on node (for a dff only its CLK input counts)
+static bool dependsOn(const simIR &ir, int reader, int node){
+  if(ir.type[reader]!=CELL_DFF) return true;
+  return ir.fanin[ir.faninStart[reader]+1]==node;
+}
+
+/*
+  Kahn's algorithm, one level at a time: the in-degree of an instance is the
+  number of its (counted) inputs driven by another instance, instances whose
+  in-degree drops to 0 form the next level.
+*/
+bool levelizeSimIR(simIR &ir){
+  vector<int> indeg(ir.numInsts, 0);
+  for(int i=0; i<ir.numInsts; i++){
+    int node=ir.out[i];
+    for(int k=ir.fanoutStart[node]; k<ir.fanoutStart[node+1]; k++){
+      if(dependsOn(ir, ir.fanout[k], node)) indeg[ir.fanout[k]]++;
+    }
+  }
+  ir.order.clear();
+  ir.levelStart.clear();
+  for(int i=0; i<ir.numInsts; i++){
+    if(indeg[i]==0) ir.order.push_back(i);
+  }
+  size_t first=0;
+  while(first<ir.order.size()){
+    size_t last=ir.order.size();
+    ir.levelStart.push_back(first);
+    for(size_t o=first; o<last; o++){
+      int node=ir.out[ir.order[o]];
+      for(int k=ir.fanoutStart[node]; k<ir.fanoutStart[node+1]; k++){
+        int reader=ir.fanout[k];
+        if(dependsOn(ir, reader, node) && --indeg[reader]==0){
+          ir.order.push_back(reader);
+        }
+      }
+    }
+    first=last;
+  }
+  ir.levelStart.push_back(ir.order.size());
+  if((int)ir.order.size()!=ir.numInsts){
+    for(int i=0; i<ir.numInsts; i++){
+      if(indeg[i]>0){
+        cerr << "-E- combinational loop through instance " << ir.insts[i]->getName() << " aborting." << endl;
+        break;
+      }
+    }
+    return false;
+  }
+  return true;
+}
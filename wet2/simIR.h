@@ -0,0 +1,154 @@
+#ifndef SIM_IR_H
+#define SIM_IR_H
+
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <vector>
+#include "hcm.h"
+#include "cellLib.h"
+
+/*
+  Compiled flat-netlist IR used by the simulator.
+  Built once after hcmFlatten: every node and every instance of the flat cell
+  gets a dense integer id, connectivity is stored as CSR arrays (fanin of each
+  instance, fanout of each node) and all node values live in one packed array
+  (simState), so the simulation loop never touches the hcm maps or string
+  properties. The simIR itself is read only during simulation.
+*/
+
+class simIR {
+  public:
+    /* nodes */
+    int numNodes;
+    std::vector<hcmNode*> nodes;      // node id -> hcm node (for vcd only)
+    std::vector<std::string> names;   // node id -> name, ids follow the sorted node map so this is sorted
+    std::vector<char> isGlobal;       // node id -> 1 for VDD/VSS
+    std::vector<int> fanoutStart;     // CSR: readers of node n are fanout[fanoutStart[n] .. fanoutStart[n+1])
+    std::vector<int> fanout;          // instance ids
+    int vddNode, vssNode;             // -1 when the node does not exist
+
+    /* instances */
+    int numInsts;
+    std::vector<hcmInstance*> insts;  // instance id -> hcm instance
+    std::vector<char> type;           // instance id -> cellType
+    std::vector<const cellDesc*> cells; // instance id -> master cell descriptor
+    std::vector<int> faninStart;      // CSR: inputs of instance i are fanin[faninStart[i] .. faninStart[i+1])
+    std::vector<int> fanin;           // node ids in the pin order of the cell, for a dff always {D, CLK}
+    std::vector<int> out;             // instance id -> output node id
+    std::vector<int> driver;          // node id -> instance driving it, -1 for inputs / globals
+
+    /* clock domains: the distinct nodes on dff CLK pins, found at compile time */
+    std::vector<int> clocks;          // domain -> clock node
+    std::vector<int> clockDomain;     // node id -> domain it clocks, -1 for other nodes
+    std::vector<int> domainStart;     // CSR: dffs of domain d are domainDffs[domainStart[d] .. domainStart[d+1])
+    std::vector<int> domainDffs;      // instance ids
+    std::vector<int> clockStage;      // domain -> 0 for a clock from the inputs, else 1 + the highest stage
+                                      // of the domains whose dffs drive its clock (divided / gated clocks)
+
+    /* levelized order (levelizeSimIR) */
+    std::vector<int> order;           // instances in topological order, a dff right after its CLK cone
+    std::vector<int> levelStart;      // CSR: instances of level l are order[levelStart[l] .. levelStart[l+1])
+
+    // returns the node id of an hcm node of the flat cell, -1 if it is not part of it
+    int nodeId(hcmNode *node) const;
+    int nodeId(const std::string &name) const;
+
+  private:
+    std::vector<std::pair<hcmNode*, int> > nodeIndex; // sorted by pointer, for nodeId()
+    friend bool buildSimIR(hcmCell *flatCell, std::set<std::string> &globalNodes, cellLibrary &lib, simIR &ir);
+    friend bool sliceSimIR(const simIR &full, const std::string &observeFile, simIR &cone);
+};
+
+// simulation state of one simulator over a (shared) simIR
+class simState {
+  public:
+    std::vector<char> val;            // node id -> current value
+    std::vector<char> unk;            // node id -> 1 when val is not 0/1 (X: val 0, Z: val 1), 4-state engine only
+    std::vector<char> prevVal;        // node id -> value before the current vector, kept for the clock nodes
+    std::vector<char> dffState;       // instance id -> data sampled by a dff (prev_val)
+    std::vector<int> changed;         // nodes changed since the last vcd dump (event driven engine)
+    std::vector<char> isChanged;      // node id -> 1 while it is in changed
+    std::vector<char> fired;          // domain -> clocked in the current vector (event driven engines)
+    std::vector<uint64_t> toggles;    // node id -> value changes applied by the event processor (-activity)
+
+    // every node false, VDD true
+    void init(const simIR &ir);
+
+    // value code of a node: 0, 1, 2 = X, 3 = Z
+    char value(int node) const {
+      return unk.empty() ? val[node] : (char)(val[node] | unk[node] << 1);
+    }
+
+    void markChanged(int node){
+      if(!isChanged[node]){
+        isChanged[node]=1;
+        changed.push_back(node);
+      }
+    }
+};
+
+// value of a combinational instance over the node values
+inline bool evalGate(const simIR &ir, const char *val, int inst){
+  int first=ir.faninStart[inst], last=ir.faninStart[inst+1];
+  char r;
+  switch(ir.type[inst]){
+    case CELL_AND:
+    case CELL_NAND:
+      r=1;
+      for(int k=first; k<last; k++) r&=val[ir.fanin[k]];
+      return ir.type[inst]==CELL_NAND ? !r : r;
+    case CELL_OR:
+    case CELL_NOR:
+      r=0;
+      for(int k=first; k<last; k++) r|=val[ir.fanin[k]];
+      return ir.type[inst]==CELL_NOR ? !r : r;
+    case CELL_XOR:
+    case CELL_XNOR:
+      r=0;
+      for(int k=first; k<last; k++) r^=val[ir.fanin[k]];
+      return ir.type[inst]==CELL_XNOR ? !r : r;
+    case CELL_INV:
+      return !val[ir.fanin[first]];
+    default:
+      return val[ir.fanin[first]];
+  }
+}
+
+// copy the clock values before a vector, a clock rises in the vector when it is 1 and was 0 here
+template<class V>
+inline void saveClocks(const simIR &ir, const std::vector<V> &val, std::vector<V> &prevVal){
+  for(size_t c=0; c<ir.clocks.size(); c++){
+    prevVal[ir.clocks[c]]=val[ir.clocks[c]];
+  }
+}
+
+// rising edge of a clock domain in the current vector
+inline bool domainEdge(const simIR &ir, const simState &st, int domain){
+  int clk_node=ir.clocks[domain];
+  return st.val[clk_node] && !st.prevVal[clk_node];
+}
+
+// rising edge on the CLK input of a dff
+inline bool dffEdge(const simIR &ir, const simState &st, int inst){
+  int clk_node=ir.fanin[ir.faninStart[inst]+1];
+  return st.val[clk_node] && !st.prevVal[clk_node];
+}
+
+// compile the flat cell into ir, returns false (after printing -E-) on unsupported cells
+bool buildSimIR(hcmCell *flatCell, std::set<std::string> &globalNodes, cellLibrary &lib, simIR &ir);
+
+/*
+  Sub-netlist of the transitive fan-in of the nodes listed in observeFile,
+  through dffs. Returns false (after printing -E-) on an unknown node.
+*/
+bool sliceSimIR(const simIR &full, const std::string &observeFile, simIR &cone);
+
+/*
+  Topological order of the instances. A dff only depends on its CLK input,
+  its D input is read after the whole order was evaluated, so dffs break the
+  sequential loops. Returns false (after printing -E-) on a combinational loop.
+*/
+bool levelizeSimIR(simIR &ir);
+
+#endif
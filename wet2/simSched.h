@@ -0,0 +1,73 @@
+#ifndef SIM_SCHED_H
+#define SIM_SCHED_H
+
+#include <vector>
+
+/*
+  Delta-cycle scheduler of the event driven simulator.
+  Each node / instance has a mark holding the stamp of the delta in which it
+  was last scheduled, so "already scheduled" is a single compare and clearing
+  all marks at the end of a delta is just incrementing the stamp.
+  Events on the same node within one delta collapse into one (last value wins).
+  V is the node value type: char for the scalar simulator, a lane word for
+  the bit-parallel one.
+*/
+template<class V>
+class deltaScheduler {
+  public:
+    std::vector<int> events;    // nodes with a pending event in this delta
+    std::vector<V> eventVal;    // node id -> pending value (valid while the node is in events)
+    std::vector<int> gates;     // instances to evaluate in this delta
+
+    void init(int numNodes,int numInsts){
+      events.clear();
+      gates.clear();
+      eventVal.assign(numNodes,V());
+      eventMark.assign(numNodes,0);
+      gateMark.assign(numInsts,0);
+      eventStamp=1;
+      gateStamp=1;
+    }
+
+    void scheduleEvent(int node,const V &val){
+      if(eventMark[node]!=eventStamp){
+        eventMark[node]=eventStamp;
+        events.push_back(node);
+      }
+      eventVal[node]=val;
+    }
+
+    void scheduleGate(int inst){
+      if(gateMark[inst]!=gateStamp){
+        gateMark[inst]=gateStamp;
+        gates.push_back(inst);
+      }
+    }
+
+    // bulk clear of the event marks, called once the pending events were applied
+    void clearEvents(){
+      events.clear();
+      if(++eventStamp==0){
+        eventMark.assign(eventMark.size(),0);
+        eventStamp=1;
+      }
+    }
+
+    // bulk clear of the gate marks, called once the scheduled gates were evaluated
+    void clearGates(){
+      gates.clear();
+      if(++gateStamp==0){
+        gateMark.assign(gateMark.size(),0);
+        gateStamp=1;
+      }
+    }
+
+  private:
+    std::vector<unsigned> eventMark;
+    std::vector<unsigned> gateMark;
+    unsigned eventStamp, gateStamp;
+};
+
+typedef deltaScheduler<char> simScheduler;
+
+#endif
@@ -0,0 +1,364 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "stimReader.h"
+
+using namespace std;
+
+stimReader::stimReader()
+  : parser(NULL), data(NULL), size(0), pos(0), packed(false), rowsLeft(0), rowsEnd(0), rowsRead(0),
+    random(false), rng(0), toggleLimit(0), line(1), error(false){
+}
+
+stimReader::~stimReader(){
+  delete parser;
+  if(data) munmap((void*)data, size);
+}
+
+static uint64_t getInt(const char *p, int bytes){
+  uint64_t v = 0;
+  for(int i=0; i<bytes; i++) v |= (uint64_t)(unsigned char)p[i] << (8*i);
+  return v;
+}
+
+// true when the file starts with the glv magic
+static bool isPacked(const string &vecsFile){
+  char magic[8];
+  FILE *f = fopen(vecsFile.c_str(), "rb");
+  if(!f) return false;
+  bool packed = fread(magic, 1, 8, f) == 8 && !memcmp(magic, GLV_MAGIC, 8);
+  fclose(f);
+  return packed;
+}
+
+bool stimReader::open(const string &sigsFile, const string &vecsFile, const simIR &ir,
+                      bool useHcm, bool verbose){
+  // hcmSigVec can not read packed vectors, they always go through the mapped reader
+  if(useHcm && !isPacked(vecsFile)){
+    parser = new hcmSigVec(sigsFile, vecsFile, verbose);
+    if(!parser->good()) return false;
+    set<string> sigs;
+    parser->getSignals(sigs);
+    names.assign(sigs.begin(), sigs.end());
+  } else if(!openText(sigsFile, vecsFile)){
+    return false;
+  }
+  return bindNodes(ir);
+}
+
+/*
+  Nodes a dff clock depends on: walking back from every CLK pin node through
+  the drivers, all inputs of a gate (clock buffers, inverters and gates) and
+  only the CLK of a dff (a divided clock comes from the clock of the divider).
+*/
+static void clockCone(const simIR &ir, vector<char> &inCone){
+  inCone.assign(ir.numNodes, 0);
+  vector<int> work(ir.clocks.begin(), ir.clocks.end());
+  for(size_t c=0; c<work.size(); c++) inCone[work[c]]=1;
+  while(!work.empty()){
+    int n=work.back();
+    work.pop_back();
+    int d=ir.driver[n];
+    if(d<0) continue;
+    int first=ir.faninStart[d], last=ir.faninStart[d+1];
+    if(ir.type[d]==CELL_DFF) first=last-1;
+    for(int k=first; k<last; k++){
+      if(!inCone[ir.fanin[k]]){
+        inCone[ir.fanin[k]]=1;
+        work.push_back(ir.fanin[k]);
+      }
+    }
+  }
+}
+
+bool stimReader::openRandom(const string &sigsFile, const simIR &ir, uint64_t count, uint64_t seed,
+                            double toggle, const string &pattern, const vector<string> &clockNames){
+  if(!readSignals(sigsFile) || !bindNodes(ir)) return false;
+  if(pattern.empty() || pattern.find_first_not_of("01") != string::npos){
+    cerr << "-E- clock pattern must be a string of 0/1: " << pattern << endl;
+    return false;
+  }
+  random = true;
+  rowsLeft = count;
+  // splitmix64 of the seed, xorshift needs a non zero state
+  rng = seed + 0x9e3779b97f4a7c15ULL;
+  rng = (rng ^ (rng >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  rng = (rng ^ (rng >> 27)) * 0x94d049bb133111ebULL;
+  rng ^= rng >> 31;
+  if(!rng) rng = 1;
+  toggleLimit = toggle <= 0 ? 0 : toggle >= 1 ? (1ULL << 53) : (uint64_t)(toggle * (double)(1ULL << 53));
+  clockPattern = pattern;
+  isClock.assign(names.size(), 0);
+  if(clockNames.empty()){
+    vector<char> inCone;
+    clockCone(ir, inCone);
+    for(size_t s=0; s<names.size(); s++){
+      isClock[s] = inCone[nodes[s]];
+    }
+  }
+  for(size_t c=0; c<clockNames.size(); c++){
+    size_t s = find(names.begin(), names.end(), clockNames[c]) - names.begin();
+    if(s == names.size()){
+      cerr << "-E- clock " << clockNames[c] << " is not a signal of " << sigsFile << endl;
+      return false;
+    }
+    isClock[s] = 1;
+  }
+  randVals.resize(names.size());
+  for(size_t s=0; s<names.size(); s++){
+    randVals[s] = nextRandom() >> 63;
+  }
+  return true;
+}
+
+uint64_t stimReader::nextRandom(){
+  rng ^= rng >> 12;
+  rng ^= rng << 25;
+  rng ^= rng >> 27;
+  return rng * 0x2545f4914f6cdd1dULL;
+}
+
+// Signals file: whitespace separated names, '#' starts a comment.
+bool stimReader::readSignals(const string &sigsFile){
+  ifstream sf(sigsFile.c_str());
+  if(!sf.good()){
+    cerr << "-E- Could not open signals file: " << sigsFile << endl;
+    return false;
+  }
+  string l;
+  while(getline(sf, l)){
+    size_t c = l.find('#');
+    if(c != string::npos) l.erase(c);
+    istringstream ls(l);
+    string name;
+    while(ls >> name) names.push_back(name);
+  }
+  return true;
+}
+
+/*
+  Vector file: mapped read only, a glv header replaces the signal list
+  (it has to list the same signals).
+*/
+bool stimReader::openText(const string &sigsFile, const string &vecsFile){
+  if(!readSignals(sigsFile)) return false;
+
+  int fd = ::open(vecsFile.c_str(), O_RDONLY);
+  struct stat sb;
+  if(fd < 0 || fstat(fd, &sb)){
+    cerr << "-E- Could not open vectors file: " << vecsFile << endl;
+    if(fd >= 0) close(fd);
+    return false;
+  }
+  size = sb.st_size;
+  if(size){
+    void *m = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(m == MAP_FAILED){
+      cerr << "-E- Could not map vectors file: " << vecsFile << endl;
+      close(fd);
+      return false;
+    }
+    madvise(m, size, MADV_SEQUENTIAL);
+    data = (const char*)m;
+  }
+  close(fd);
+
+  if(size < 8 || memcmp(data, GLV_MAGIC, 8)) return true;
+
+  // packed vectors
+  packed = true;
+  bool ok = size >= 12;
+  size_t nsig = ok ? getInt(data+8, 4) : 0;
+  vector<string> glvNames;
+  pos = 12;
+  for(size_t s=0; ok && s<nsig; s++){
+    ok = pos+4 <= size;
+    size_t len = ok ? getInt(data+pos, 4) : 0;
+    ok = ok && pos+4+len <= size;
+    if(ok) glvNames.push_back(string(data+pos+4, len));
+    pos += 4+len;
+  }
+  ok = ok && pos+8 <= size;
+  if(ok){
+    rowsLeft = getInt(data+pos, 8);
+    pos += 8;
+    ok = rowsLeft <= (size-pos)/((nsig+7)/8 ? (nsig+7)/8 : 1);
+    rowsEnd = pos + rowsLeft*((nsig+7)/8);
+  }
+  if(!ok){
+    cerr << "-E- corrupted packed vectors file: " << vecsFile << endl;
+    return false;
+  }
+  // the order of the glv (file order, or sorted when packed from hcmSigVec) is the vector order
+  vector<string> a(glvNames), b(names);
+  sort(a.begin(), a.end());
+  sort(b.begin(), b.end());
+  if(a != b){
+    cerr << "-E- the signals of " << vecsFile << " differ from " << sigsFile << endl;
+    return false;
+  }
+  names = glvNames;
+  return true;
+}
+
+bool stimReader::bindNodes(const simIR &ir){
+  nodes.clear();
+  for(size_t s=0; s<names.size(); s++){
+    int id = ir.nodeId(names[s]);
+    if(id<0){
+      cerr << "-E- signal " << names[s] << " is not a node of the top cell, aborting." << endl;
+      return false;
+    }
+    nodes.push_back(id);
+  }
+  return true;
+}
+
+bool stimReader::next(vector<char> &vals){
+  size_t nsig = names.size();
+  vals.resize(nsig);
+  if(parser){
+    if(parser->readVector() != 0) return false;
+    rowsRead++;
+    for(size_t s=0; s<nsig; s++){
+      bool v=false;
+      parser->getSigValue(names[s], v);
+      vals[s]=v;
+    }
+    return true;
+  }
+
+  if(random){
+    if(!rowsLeft) return false;
+    char clk = clockPattern[rowsRead % clockPattern.size()] - '0';
+    for(size_t s=0; s<nsig; s++){
+      if(isClock[s]){
+        randVals[s] = clk;
+      } else if((nextRandom() >> 11) < toggleLimit){
+        randVals[s] ^= 1;
+      }
+      vals[s] = randVals[s];
+    }
+    rowsRead++;
+    rowsLeft--;
+    return true;
+  }
+
+  if(packed){
+    if(!rowsLeft) return false;
+    const unsigned char *r = (const unsigned char*)data + pos;
+    for(size_t s=0; s<nsig; s++){
+      vals[s] = (r[s>>3] >> (s&7)) & 1;
+    }
+    pos += (nsig+7)/8;
+    rowsLeft--;
+    return true;
+  }
+
+  // text row: '0'/'1' values up to the end of a non empty line
+  size_t n = 0, rowLine = line;
+  while(pos < size){
+    char c = data[pos++];
+    if(c == '0' || c == '1'){
+      if(!n) rowLine = line;
+      if(n < nsig) vals[n] = c - '0';
+      n++;
+    } else if(c == '\n'){
+      line++;
+      if(n) break;
+    } else if(c == '#'){
+      while(pos < size && data[pos] != '\n') pos++;
+    } else if(c != ' ' && c != '\t' && c != '\r'){
+      cerr << "-E- unexpected character '" << c << "' in vectors file line " << line << endl;
+      error = true;
+      return false;
+    }
+  }
+  if(!n) return false;
+  if(n != nsig){
+    cerr << "-E- vectors file line " << rowLine << " has " << n << " values, expected " << nsig << endl;
+    error = true;
+    return false;
+  }
+  return true;
+}
+
+bool stimReader::seek(uint64_t off, size_t atLine){
+  if(parser || random){
+    vector<char> vals;
+    while(rowsRead < off){
+      if(!next(vals)){
+        cerr << "-E- the vectors file ends before vector " << off << endl;
+        return false;
+      }
+    }
+    return true;
+  }
+  bool ok;
+  if(packed){
+    size_t rowBytes = (names.size()+7)/8;
+    ok = off >= pos && off <= rowsEnd && (!rowBytes || (rowsEnd-off)%rowBytes == 0);
+    if(ok) rowsLeft = rowBytes ? (rowsEnd-off)/rowBytes : 0;
+  } else {
+    ok = off <= size && (off == 0 || off == size || data[off-1] == '\n');
+  }
+  if(!ok){
+    cerr << "-E- offset " << off << " is not a vector of the vectors file" << endl;
+    return false;
+  }
+  pos = off;
+  line = atLine;
+  return true;
+}
+
+long packVectors(stimReader &in, const string &fileName){
+  FILE *f = fopen(fileName.c_str(), "wb");
+  if(!f){
+    cerr << "-E- Could not create packed vectors file: " << fileName << endl;
+    return -1;
+  }
+  size_t nsig = in.names.size();
+  string h(GLV_MAGIC);
+  for(int i=0; i<4; i++) h += (char)(nsig >> (8*i));
+  for(size_t s=0; s<nsig; s++){
+    for(int i=0; i<4; i++) h += (char)(in.names[s].size() >> (8*i));
+    h += in.names[s];
+  }
+  size_t countPos = h.size();
+  h.append(8, '\0');
+  bool ok = fwrite(h.data(), 1, h.size(), f) == h.size();
+
+  vector<char> vals;
+  vector<unsigned char> row((nsig+7)/8);
+  uint64_t rows = 0;
+  while(in.next(vals)){
+    memset(row.data(), 0, row.size());
+    for(size_t s=0; s<nsig; s++){
+      row[s>>3] |= vals[s] << (s&7);
+    }
+    ok = ok && fwrite(row.data(), 1, row.size(), f) == row.size();
+    rows++;
+  }
+  // the row count is only known at the end
+  unsigned char cnt[8];
+  for(int i=0; i<8; i++) cnt[i] = (unsigned char)(rows >> (8*i));
+  ok = ok && fseek(f, countPos, SEEK_SET) == 0 && fwrite(cnt, 1, 8, f) == 8;
+  ok = (fclose(f) == 0) && ok;
+  if(!ok){
+    cerr << "-E- Could not write packed vectors file: " << fileName << endl;
+    // no truncated glv left behind (but never remove a device given as the output)
+    struct stat sb;
+    if(stat(fileName.c_str(), &sb) == 0 && S_ISREG(sb.st_mode)) remove(fileName.c_str());
+    return -1;
+  }
+  if(in.failed()) return -1;
+  return rows;
+}
@@ -0,0 +1,89 @@
+#ifndef STIM_READER_H
+#define STIM_READER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "hcmsigvec.h"
+#include "simIR.h"
+
+/*
+  Stimulus front end of the simulator.
+  The signal names are resolved to node ids once when the files are opened,
+  after that every vector is delivered as one value per signal in the order
+  of `nodes`, with no string lookups.
+
+  Vector file formats:
+    text   one row per vector, one '0'/'1' per signal in the order of the
+           signals file, blanks ignored, '#' starts a comment. The file is
+           memory mapped and split by a small tokenizer.
+    glv    packed binary (written by -pack), detected by its magic:
+           "GLVEC001", u32 nsig, (u32 length, name)*nsig, u64 nrows,
+           then nrows rows of (nsig+7)/8 bytes, signal s in bit s%8 of byte s/8.
+  With useHcm (the default of gl_sim, -stim fast selects the mapped reader)
+  the text vectors are read through hcmSigVec instead (any format the hcm
+  library understands, signals in sorted order); a glv file is always read
+  by the mapped reader, in the signal order stored in it.
+  openRandom generates the vectors in process instead (-random): every
+  signal toggles with a given probability per vector, drawn from a seeded
+  xorshift64* generator, and the clock signals follow a fixed pattern. The
+  clock signals are the given names, or else every signal in the fan-in of a
+  dff CLK pin (through buffers, clock gates and the CLK of divider dffs).
+*/
+#define GLV_MAGIC "GLVEC001"
+
+class stimReader {
+  public:
+    std::vector<std::string> names;   // signal names, in the order of the vector values
+    std::vector<int> nodes;           // signal -> node id
+
+    stimReader();
+    ~stimReader();
+    // returns false (after printing -E-) on unreadable files or unknown signals
+    bool open(const std::string &sigsFile, const std::string &vecsFile, const simIR &ir,
+              bool useHcm, bool verbose);
+    // count pseudo random vectors over the signals of sigsFile. toggle is the probability
+    // a signal changes in a vector, clockPattern the values of the clock signals (repeated, e.g. "01"),
+    // clockNames the clock signals (empty: found from the dff clocks)
+    bool openRandom(const std::string &sigsFile, const simIR &ir, uint64_t count, uint64_t seed,
+                    double toggle, const std::string &clockPattern,
+                    const std::vector<std::string> &clockNames);
+    // values of the next vector, false at the end of the file or on a bad row
+    bool next(std::vector<char> &vals);
+    // a bad row stopped the reading
+    bool failed() const { return error; }
+    // position of the next vector, for checkpoints: byte offset of the vector file
+    // (lineNum() is the text line there), number of vectors read with useHcm or generated
+    uint64_t offset() const { return parser || random ? rowsRead : pos; }
+    size_t lineNum() const { return line; }
+    // continue at a position returned by offset(), returns false (after printing -E-)
+    // when it is not a vector boundary of this file. useHcm and random re-read the vectors before it.
+    bool seek(uint64_t off, size_t atLine);
+
+  private:
+    hcmSigVec *parser;                // useHcm
+    const char *data;                 // mapped vector file
+    size_t size, pos;
+    bool packed;                      // glv file, rows start at pos
+    size_t rowsLeft;
+    size_t rowsEnd;                   // glv: end of the rows
+    uint64_t rowsRead;                // vectors read through the parser or generated
+    bool random;                      // openRandom
+    uint64_t rng;                     // xorshift64* state
+    uint64_t toggleLimit;             // a signal toggles when the 53 bit draw is below it
+    std::string clockPattern;         // values of the clock signals
+    std::vector<char> isClock;        // signal -> it follows clockPattern
+    std::vector<char> randVals;       // current values of the generated signals
+    size_t line;                      // current line of a text file, for messages
+    bool error;
+
+    bool readSignals(const std::string &sigsFile);
+    bool openText(const std::string &sigsFile, const std::string &vecsFile);
+    uint64_t nextRandom();
+    bool bindNodes(const simIR &ir);
+};
+
+// write the remaining vectors of in as a packed glv file, returns the number of rows or -1
+long packVectors(stimReader &in, const std::string &fileName);
+
+#endif
@@ -0,0 +1,14 @@
+// dff clocked through a chain of buffers while D changes in the same vector
+module and2(A,B,Y); input A,B; output Y; endmodule
+module buffer(A,Y); input A; output Y; endmodule
+module dff(D,CLK,Q); input D,CLK; output Q; endmodule
+
+module bufclk(A,CLK,Q);
+ input A,CLK; output Q; wire c1,c2,c3,d,q;
+ buffer b1(.A(CLK),.Y(c1));
+ buffer b2(.A(c1),.Y(c2));
+ buffer b3(.A(c2),.Y(c3));
+ buffer bd(.A(A),.Y(d));
+ dff r1(.D(d),.CLK(c3),.Q(q));
+ buffer bq(.A(q),.Y(Q));
+endmodule
@@ -0,0 +1,23 @@
+// register behind a clock gate and a clock buffer next to one on the free
+// running clock, a slow enable glitching the gated clock and a divided clock
+module and2(A,B,Y); input A,B; output Y; endmodule
+module xor2(A,B,Y); input A,B; output Y; endmodule
+module inv(A,Y); input A; output Y; endmodule
+module buffer(A,Y); input A; output Y; endmodule
+module dff(D,CLK,Q); input D,CLK; output Q; endmodule
+
+module gatedclk(A,EN,CLK,Q1,Q2,Q3);
+ input A,EN,CLK; output Q1,Q2,Q3; wire en1,en2,gclk,bclk,d,q1,q2,q3,nq3;
+ buffer be1(.A(EN),.Y(en1));
+ buffer be2(.A(en1),.Y(en2));
+ and2 cg(.A(CLK),.B(en2),.Y(gclk));
+ buffer bg(.A(gclk),.Y(bclk));
+ xor2 x1(.A(A),.B(q1),.Y(d));
+ dff r1(.D(d),.CLK(bclk),.Q(q1));
+ dff r2(.D(q1),.CLK(CLK),.Q(q2));
+ inv n3(.A(q3),.Y(nq3));
+ dff r3(.D(nq3),.CLK(q2),.Q(q3));
+ buffer b1(.A(q1),.Y(Q1));
+ buffer b2(.A(q2),.Y(Q2));
+ buffer b3(.A(q3),.Y(Q3));
+endmodule
@@ -0,0 +1,179 @@
+#ifndef TIME_WHEEL_H
+#define TIME_WHEEL_H
+
+#include <stdint.h>
+#include <vector>
+
+/*
+  Hierarchical timing wheel of node events.
+  TW_LEVELS wheels of 256 slots: an event at time t sits on the lowest level
+  whose slot still tells it apart from the current time (level 0 = same
+  256 block as now, one slot per time unit), events further away than the
+  top wheel wait in an overflow list. Moving to a higher level slot cascades
+  its events down, so insert is O(1) and finding the next time is a bitmap
+  scan per level.
+  Events live in a pool and are referenced by index. Every node has at most
+  one pending event (the last one scheduled), cancel() marks it dead in O(1)
+  and it is freed when its slot comes up.
+*/
+#define TW_LEVELS 4
+#define TW_SLOTS  256
+
+class timeWheel {
+  public:
+    uint64_t now;                     // time of the last popped slot
+    std::vector<int> pending;         // node id -> its scheduled event, -1 if none
+
+    void init(int numNodes){
+      now=0;
+      pending.assign(numNodes, -1);
+      evTime.clear(); evNode.clear(); evVal.clear(); evNext.clear();
+      freeList=-1;
+      for(int l=0; l<TW_LEVELS; l++){
+        for(int s=0; s<TW_SLOTS; s++) head[l][s]=-1;
+        for(int w=0; w<TW_SLOTS/64; w++) used[l][w]=0;
+      }
+      overflow.clear();
+    }
+
+    // schedule node=val at time t >= now, replacing the pending event of the node
+    void schedule(uint64_t t, int node, char val){
+      cancel(node);
+      int e=alloc();
+      evTime[e]=t; evNode[e]=node; evVal[e]=val;
+      pending[node]=e;
+      insert(e);
+    }
+
+    void cancel(int node){
+      int e=pending[node];
+      if(e>=0){
+        evNode[e]=-1;
+        pending[node]=-1;
+      }
+    }
+
+    // value of the pending event of node (only valid when pending[node] >= 0)
+    char pendingVal(int node) const { return evVal[pending[node]]; }
+
+    /*
+      Move to the earliest time before end holding events and append its
+      (live) events to nodes/vals. Returns false, without moving, when no
+      event is due before end.
+    */
+    bool popBefore(uint64_t end, std::vector<int> &nodes, std::vector<char> &vals){
+      while(true){
+        int s=findSlot(0, now & (TW_SLOTS-1));
+        if(s>=0){
+          uint64_t t=(now & ~(uint64_t)(TW_SLOTS-1)) | s;
+          if(t>=end) return false;
+          now=t;
+          int e=head[0][s];
+          head[0][s]=-1;
+          used[0][s>>6]&=~((uint64_t)1<<(s&63));
+          while(e>=0){
+            int next=evNext[e];
+            if(evNode[e]>=0){
+              nodes.push_back(evNode[e]);
+              vals.push_back(evVal[e]);
+              pending[evNode[e]]=-1;
+            }
+            release(e);
+            e=next;
+          }
+          return true;
+        }
+        if(!cascade(end)) return false;
+      }
+    }
+
+  private:
+    std::vector<uint64_t> evTime;
+    std::vector<int> evNode;          // -1 once cancelled
+    std::vector<char> evVal;
+    std::vector<int> evNext;          // slot list / free list link
+    int freeList;
+    int head[TW_LEVELS][TW_SLOTS];
+    uint64_t used[TW_LEVELS][TW_SLOTS/64];  // occupied slots
+    std::vector<int> overflow;
+
+    int alloc(){
+      if(freeList>=0){
+        int e=freeList;
+        freeList=evNext[e];
+        return e;
+      }
+      evTime.push_back(0); evNode.push_back(-1); evVal.push_back(0); evNext.push_back(-1);
+      return evTime.size()-1;
+    }
+    void release(int e){
+      evNext[e]=freeList;
+      freeList=e;
+    }
+
+    void insert(int e){
+      uint64_t t=evTime[e];
+      for(int l=0; l<TW_LEVELS; l++){
+        int shift=8*(l+1);
+        if(shift>=64 || (t>>shift)==(now>>shift)){
+          int s=(t>>(8*l)) & (TW_SLOTS-1);
+          evNext[e]=head[l][s];
+          head[l][s]=e;
+          used[l][s>>6]|=(uint64_t)1<<(s&63);
+          return;
+        }
+      }
+      overflow.push_back(e);
+    }
+
+    // first occupied slot >= from on level l, -1 if none
+    int findSlot(int l, int from) const{
+      for(int w=from>>6; w<TW_SLOTS/64; w++){
+        uint64_t m=used[l][w];
+        if(w==(from>>6)) m&=~(uint64_t)0<<(from&63);
+        if(m) return (w<<6) + __builtin_ctzll(m);
+      }
+      return -1;
+    }
+
+    /*
+      Level 0 is empty up to the end of the current block: move now to the
+      start of the next occupied higher level slot (if before end) and
+      re-insert its events one level lower.
+    */
+    bool cascade(uint64_t end){
+      for(int l=1; l<TW_LEVELS; l++){
+        int cur=(now>>(8*l)) & (TW_SLOTS-1);
+        int s=cur+1<TW_SLOTS ? findSlot(l, cur+1) : -1;
+        if(s<0) continue;
+        int shift=8*(l+1);
+        uint64_t high=shift>=64 ? 0 : (now>>shift)<<shift;
+        uint64_t t=high | ((uint64_t)s<<(8*l));
+        if(t>=end) return false;
+        now=t;
+        int e=head[l][s];
+        head[l][s]=-1;
+        used[l][s>>6]&=~((uint64_t)1<<(s&63));
+        while(e>=0){
+          int next=evNext[e];
+          insert(e);
+          e=next;
+        }
+        return true;
+      }
+      // the wheels are empty: jump to the earliest overflow event
+      if(overflow.empty()) return false;
+      uint64_t tmin=~(uint64_t)0;
+      for(size_t i=0; i<overflow.size(); i++){
+        if(evTime[overflow[i]]<tmin) tmin=evTime[overflow[i]];
+      }
+      if(tmin>=end) return false;
+      now=tmin;
+      std::vector<int> ov;
+      ov.swap(overflow);
+      for(size_t i=0; i<ov.size(); i++) insert(ov[i]);
+      return true;
+    }
+};
+
+#endif
@@ -0,0 +1,214 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include "timedSim.h"
+
+using namespace std;
+
+timedSim::timedSim(const simIR &ir_)
+  : timescale("1ns"), ir(ir_), rise(ir_.numInsts, 1), fall(ir_.numInsts, 1),
+    gateMark(ir_.numInsts, 0), delta(0), first(true), stepOpen(false), dumpTime(0), dumped(false){
+  wheel.init(ir.numNodes);
+}
+
+bool timedSim::loadDelays(const string &fileName){
+  ifstream f(fileName.c_str());
+  if(!f.good()){
+    cerr << "-E- Could not open delay file: " << fileName << endl;
+    return false;
+  }
+  map<string, pair<unsigned, unsigned> > cells;
+  pair<unsigned, unsigned> def(1, 1);
+  string l;
+  int lineNum=0;
+  while(getline(f, l)){
+    lineNum++;
+    size_t c=l.find('#');
+    if(c!=string::npos) l.erase(c);
+    istringstream ls(l);
+    string name;
+    if(!(ls >> name)) continue;
+    if(name=="timescale"){
+      if(!(ls >> timescale)){
+        cerr << "-E- " << fileName << ":" << lineNum << ": timescale needs a unit" << endl;
+        return false;
+      }
+      continue;
+    }
+    long r, fl;
+    if(!(ls >> r >> fl) || r<0 || fl<0){
+      cerr << "-E- " << fileName << ":" << lineNum << ": expected <cell> <rise> <fall>" << endl;
+      return false;
+    }
+    if(name=="*") def=make_pair((unsigned)r, (unsigned)fl);
+    else cells[name]=make_pair((unsigned)r, (unsigned)fl);
+  }
+  for(int i=0; i<ir.numInsts; i++){
+    map<string, pair<unsigned, unsigned> >::iterator I=cells.find(ir.cells[i]->name);
+    pair<unsigned, unsigned> d = I==cells.end() ? def : I->second;
+    rise[i]=d.first;
+    fall[i]=d.second;
+  }
+  return true;
+}
+
+uint64_t timedSim::criticalPath() const{
+  vector<uint64_t> arrival(ir.numNodes, 0);
+  uint64_t worst=0;
+  for(size_t o=0; o<ir.order.size(); o++){
+    int inst=ir.order[o];
+    uint64_t a=0;
+    if(ir.type[inst]==CELL_DFF){
+      a=arrival[ir.fanin[ir.faninStart[inst]+1]];
+    } else {
+      for(int k=ir.faninStart[inst]; k<ir.faninStart[inst+1]; k++){
+        if(arrival[ir.fanin[k]]>a) a=arrival[ir.fanin[k]];
+      }
+    }
+    a+=rise[inst]>fall[inst] ? rise[inst] : fall[inst];
+    arrival[ir.out[inst]]=a;
+    if(a>worst) worst=a;
+  }
+  return worst;
+}
+
+void timedSim::simulate(simState &st, vector<int> &sigNodes, vector<char> &sigVals,
+                        uint64_t t0, uint64_t period, waveWriter &wave){
+  for(size_t s=0; s<sigNodes.size(); s++){
+    wheel.schedule(t0, sigNodes[s], sigVals[s]);
+  }
+  run(st, t0+period, wave);
+}
+
+void timedSim::finish(simState &st, waveWriter &wave){
+  run(st, ~(uint64_t)0, wave);
+  if(!st.changed.empty() || !dumped){
+    dumped=true;
+    wave.changeTime(dumpTime);
+    wave.dumpChanges(st, true);
+  }
+}
+
+/*
+  Pop the event deltas of the wheel up to end. The changes of one time are
+  written together once the wheel moves to a later time, so zero width
+  pulses within a time step never reach the waveform.
+  The dffs are not evaluated by the deltas: once a time step has settled the
+  domains whose clock rose over the step are clocked (clockEdges), their
+  outputs follow after the dff delay (in the same step for a zero delay,
+  which settles again), then the other domains sample D (sampleDomains).
+*/
+void timedSim::run(simState &st, uint64_t end, waveWriter &wave){
+  vector<int> nodes;
+  vector<char> vals;
+  while(true){
+    // the deltas left in the current time step first
+    if(!stepOpen || !wheel.popBefore(wheel.now+1, nodes, vals)){
+      if(stepOpen){
+        if(clockEdges(st)) continue;
+        sampleDomains(st);
+        stepOpen=false;
+      }
+      if(!wheel.popBefore(end, nodes, vals)) break;
+      stepOpen=true;
+      saveClocks(ir, st.val, st.prevVal);
+      st.fired.assign(ir.clocks.size(), 0);
+    }
+    uint64_t t=wheel.now;
+    // the first dump (all nodes) is at the time of the first delta even without changes
+    if(t!=dumpTime && (!st.changed.empty() || !dumped)){
+      dumped=true;
+      wave.changeTime(dumpTime);
+      wave.dumpChanges(st, true);
+    }
+    dumpTime=t;
+    if(++delta==0){
+      gateMark.assign(gateMark.size(), 0);
+      delta=1;
+    }
+
+    // apply the events, queue the (combinational) readers of the changed nodes
+    for(size_t e=0; e<nodes.size(); e++){
+      int node=nodes[e];
+      if(st.val[node]==vals[e]) continue;
+      st.val[node]=vals[e];
+      st.markChanged(node);
+      if(!st.toggles.empty()) st.toggles[node]++;
+      for(int k=ir.fanoutStart[node]; k<ir.fanoutStart[node+1]; k++){
+        int inst=ir.fanout[k];
+        if(ir.type[inst]!=CELL_DFF && gateMark[inst]!=delta){
+          gateMark[inst]=delta;
+          gates.push_back(inst);
+        }
+      }
+    }
+    nodes.clear();
+    vals.clear();
+    // the first delta evaluates every gate once
+    if(first){
+      first=false;
+      gates.clear();
+      for(int i=0; i<ir.numInsts; i++){
+        if(ir.type[i]!=CELL_DFF) gates.push_back(i);
+      }
+    }
+
+    // evaluate, schedule the outputs after the rise / fall delay
+    for(size_t g=0; g<gates.size(); g++){
+      int inst=gates[g];
+      schedule(st, inst, evalGate(ir, st.val.data(), inst), t);
+    }
+    gates.clear();
+  }
+}
+
+// output of inst at t + its rise / fall delay, replacing a pending event with another value
+void timedSim::schedule(simState &st, int inst, bool result, uint64_t t){
+  int out=ir.out[inst];
+  if(wheel.pending[out]>=0){
+    if(wheel.pendingVal(out)==result) return;
+    wheel.cancel(out);
+  }
+  if((bool)st.val[out]!=result){
+    wheel.schedule(t + (result ? rise[inst] : fall[inst]), out, result);
+  }
+}
+
+// settled time step: the domains whose clock rose over the step and which were not clocked
+// yet, of the lowest clock stage, output their sampled data. returns false when none is left.
+bool timedSim::clockEdges(simState &st){
+  int stage=-1;
+  for(size_t d=0; d<ir.clocks.size(); d++){
+    if(!st.fired[d] && domainEdge(ir, st, d) && (stage<0 || ir.clockStage[d]<stage)){
+      stage=ir.clockStage[d];
+    }
+  }
+  if(stage<0){
+    return false;
+  }
+  for(size_t d=0; d<ir.clocks.size(); d++){
+    if(st.fired[d] || !domainEdge(ir, st, d) || ir.clockStage[d]!=stage){
+      continue;
+    }
+    st.fired[d]=1;
+    for(int k=ir.domainStart[d]; k<ir.domainStart[d+1]; k++){
+      int inst=ir.domainDffs[k];
+      schedule(st, inst, st.dffState[inst], wheel.now);
+    }
+  }
+  return true;
+}
+
+// end of a time step: the dffs of the domains without an edge sample their settled D
+void timedSim::sampleDomains(simState &st){
+  for(size_t d=0; d<ir.clocks.size(); d++){
+    if(domainEdge(ir, st, d)){
+      continue;
+    }
+    for(int k=ir.domainStart[d]; k<ir.domainStart[d+1]; k++){
+      int inst=ir.domainDffs[k];
+      st.dffState[inst]=st.val[ir.fanin[ir.faninStart[inst]]];
+    }
+  }
+}
@@ -0,0 +1,63 @@
+#ifndef TIMED_SIM_H
+#define TIMED_SIM_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "simIR.h"
+#include "timeWheel.h"
+#include "waveWriter.h"
+
+/*
+  Event driven simulation with per-cell rise/fall delays (-engine timed).
+  A gate evaluated at time t schedules its output at t+rise or t+fall on a
+  timing wheel. Delays are inertial: a new evaluation replaces the pending
+  event of the output, and a pulse shorter than the gate delay is
+  cancelled. Clocks follow the zero-delay engines, per time step: once a
+  step settled, the domains whose clock is 1 and was 0 at the start of the
+  step output their sampled data after the dff delay (a glitch within the
+  step clocks nothing), then the other domains sample D. With all delays 0
+  and -period 1 the waveform matches -engine event.
+  Vector k is applied at time k*period and the waveform is written in the
+  units of the delay file.
+
+  Delay file, one entry per line, '#' starts a comment:
+    timescale 10ps          units of the delays and of the vcd (default 1ns)
+    nand2 3 2               rise and fall delay of a master cell
+    * 1 1                   delays of the cells not listed (default 1 1)
+*/
+class timedSim {
+  public:
+    std::string timescale;
+
+    timedSim(const simIR &ir);
+    // returns false (after printing -E-) on a bad delay file
+    bool loadDelays(const std::string &fileName);
+    // longest rise/fall path through the combinational logic, the default vector period - 1
+    uint64_t criticalPath() const;
+
+    // apply the vector at time t0 and simulate up to t0+period (exclusive)
+    void simulate(simState &st, std::vector<int> &sigNodes, std::vector<char> &sigVals,
+                  uint64_t t0, uint64_t period, waveWriter &wave);
+    // simulate the events still pending after the last vector
+    void finish(simState &st, waveWriter &wave);
+
+  private:
+    const simIR &ir;
+    std::vector<unsigned> rise, fall;   // instance id -> delays
+    timeWheel wheel;
+    std::vector<int> gates;             // instances to evaluate in this delta
+    std::vector<unsigned> gateMark;     // instance id -> delta it was queued in
+    unsigned delta;
+    bool first;
+    bool stepOpen;                      // deltas of the time wheel.now were popped, its clocks not handled yet
+    uint64_t dumpTime;                  // time of the changes in st.changed
+    bool dumped;                        // the first (full) dump was written
+
+    void run(simState &st, uint64_t end, waveWriter &wave);
+    void schedule(simState &st, int inst, bool result, uint64_t t);
+    bool clockEdges(simState &st);
+    void sampleDomains(simState &st);
+};
+
+#endif
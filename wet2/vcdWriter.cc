@@ -0,0 +1,77 @@
+#include <string.h>
+#include <iostream>
+#include "vcdWriter.h"
+
+using namespace std;
+
+// vcd identifier of the n'th variable: base 94 over the printable characters '!'..'~'
+static string vcdId(int n){
+  string id;
+  do {
+    id += (char)('!' + n % 94);
+    n /= 94;
+  } while(n);
+  return id;
+}
+
+vcdWriter::vcdWriter(const string &fileName, const simIR &ir_, const string &cellName, const string &timescale)
+  : waveWriter(ir_), name(fileName), failed(false), used(0){
+  f = fopen(fileName.c_str(), "w");
+  buf = new char[VCD_BUFFER_SIZE];
+  ids.resize(ir.numNodes);
+  if(!f) return;
+
+  string h = "$version gl_sim $end\n$timescale " + timescale + " $end\n";
+  h += "$scope module " + cellName + " $end\n";
+  write(h.data(), h.size());
+  int n=0;
+  for(int node=0; node<ir.numNodes; node++){
+    if(ir.isGlobal[node]) continue;
+    ids[node] = vcdId(n++);
+    string v = "$var wire 1 " + ids[node] + " " + ir.names[node] + " $end\n";
+    write(v.data(), v.size());
+  }
+  h = "$upscope $end\n$enddefinitions $end\n";
+  write(h.data(), h.size());
+}
+
+vcdWriter::~vcdWriter(){
+  flush();
+  if(f && fclose(f) != 0) failed = true;
+  if(failed){
+    cerr << "-E- Could not write waveform file: " << name << endl;
+  }
+  delete[] buf;
+}
+
+void vcdWriter::write(const char *s, size_t n){
+  if(used + n > VCD_BUFFER_SIZE){
+    flush();
+  }
+  if(n > VCD_BUFFER_SIZE){
+    if(f && fwrite(s, 1, n, f) != n) failed = true;
+    return;
+  }
+  memcpy(buf + used, s, n);
+  used += n;
+}
+
+void vcdWriter::flush(){
+  if(f && used && fwrite(buf, 1, used, f) != used) failed = true;
+  used = 0;
+}
+
+void vcdWriter::changeTime(unsigned long long time){
+  char t[32];
+  int n = snprintf(t, sizeof(t), "#%llu\n", time);
+  write(t, n);
+}
+
+void vcdWriter::writeValue(int node, char val){
+  const string &id = ids[node];
+  if(used + id.size() + 2 > VCD_BUFFER_SIZE) flush();
+  buf[used++] = "01xz"[(int)val];
+  memcpy(buf + used, id.data(), id.size());
+  used += id.size();
+  buf[used++] = '\n';
+}
@@ -0,0 +1,44 @@
+#ifndef VCD_WRITER_H
+#define VCD_WRITER_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "simIR.h"
+#include "waveWriter.h"
+
+/*
+  Buffered VCD writer over simIR node ids.
+  Every non-global node gets a short VCD identifier once and only nodes
+  whose value changed are written (see waveWriter). Output goes through a
+  large private buffer, so the dump cost follows the activity and not the
+  design size. A write error is remembered and reported (-E-) when the
+  writer is deleted.
+*/
+#define VCD_BUFFER_SIZE (4 << 20)
+
+class vcdWriter : public waveWriter {
+  public:
+    vcdWriter(const std::string &fileName, const simIR &ir, const std::string &cellName,
+              const std::string &timescale = "1ns");
+    ~vcdWriter();
+    bool good() const { return f != NULL; }
+
+    void changeTime(unsigned long long time);
+    void flush();
+
+  protected:
+    void writeValue(int node, char val);
+
+  private:
+    FILE *f;
+    std::string name;
+    bool failed;                      // a write failed
+    std::vector<std::string> ids;     // node id -> vcd identifier, empty for global nodes
+    char *buf;
+    size_t used;
+
+    void write(const char *s, size_t n);
+};
+
+#endif
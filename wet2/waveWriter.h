@@ -0,0 +1,63 @@
+#ifndef WAVE_WRITER_H
+#define WAVE_WRITER_H
+
+#include <vector>
+#include "simIR.h"
+
+/*
+  Base of the waveform writers (text vcd, binary glw).
+  Keeps the last dumped value of every node, so only nodes whose value
+  differs from it reach writeValue(). Values are 0, 1, 2 = x, 3 = z.
+*/
+class waveWriter {
+  public:
+    waveWriter(const simIR &ir_) : ir(ir_), last(ir_.numNodes, 4), started(false) {}
+    virtual ~waveWriter() {}
+    virtual bool good() const = 0;
+    virtual void changeTime(unsigned long long time) = 0;
+
+    // write node if its value differs from the last dumped one
+    void changeValue(int node, char val){
+      if(last[node] == val || ir.isGlobal[node]) return;
+      last[node] = val;
+      writeValue(node, val);
+    }
+
+    // dump the nodes the engine marked as changed (st.changed), or all nodes when untracked.
+    // the first dump writes every node.
+    void dumpChanges(simState &st, bool tracked){
+      if(!tracked || !started){
+        for(int node=0; node<ir.numNodes; node++){
+          changeValue(node, st.value(node));
+        }
+        started = true;
+        if(!tracked) return;
+      }
+      for(size_t c=0; c<st.changed.size(); c++){
+        int node = st.changed[c];
+        st.isChanged[node] = 0;
+        changeValue(node, st.value(node));
+      }
+      st.changed.clear();
+    }
+
+  protected:
+    const simIR &ir;
+    std::vector<char> last;           // node id -> last dumped value code, 4 = never dumped
+    bool started;                     // the first dump was written
+
+    virtual void writeValue(int node, char val) = 0;
+};
+
+// -wave none: drops the values, for benchmarking the engines without the waveform i/o
+class nullWriter : public waveWriter {
+  public:
+    nullWriter(const simIR &ir_) : waveWriter(ir_) {}
+    bool good() const { return true; }
+    void changeTime(unsigned long long) {}
+
+  protected:
+    void writeValue(int, char) {}
+};
+
+#endif